@@ -0,0 +1,531 @@
+// Build: gcc -O2 -shared -fPIC -fno-omit-frame-pointer allocprof.c -o build/allocprof.so -ldl
+// Usage: LD_PRELOAD=./build/allocprof.so ./build/memptr
+//
+// Allocation profiler loaded with LD_PRELOAD. It interposes malloc, calloc,
+// realloc, free and the aligned allocators, and attributes each sampled
+// allocation to a call site: a short frame-pointer backtrace of the caller.
+// At exit it writes the sites sorted by bytes, with counts, lifetimes and
+// hints:
+//   arena?   most blocks die within ALLOCPROF_SHORT_US (bump/arena candidate)
+//   regrow   realloc grows blocks in small steps (<1.5x), i.e. not geometrically
+//   live     blocks still allocated at exit
+//
+// Environment:
+//   ALLOCPROF_SAMPLE=N    profile ~1 in N allocations (default 1 = all).
+//                         Unsampled allocations only decrement a thread-local
+//                         counter; free() of an untracked block is one load
+//                         from a counting filter, locking only on a filter hit.
+//   ALLOCPROF_DEPTH=D     frames per site, 1..8 (default 1: the return address,
+//                         right for any build). Deeper frames walk saved frame
+//                         pointers, so the profiled program must be built with
+//                         -fno-omit-frame-pointer or sites get garbage frames;
+//                         the walk never leaves the thread's stack either way.
+//                         Frames inside operator new/new[] are skipped, so a
+//                         C++ site starts at the new-expression.
+//   ALLOCPROF_SHORT_US=T  "short-lived" threshold in microseconds (default 100)
+//   ALLOCPROF_TOP=K       sites in the report (default 25)
+//   ALLOCPROF_OUT=path    report file (default: stderr as it was at startup,
+//                         so programs that close fd 2 still get a report)
+//
+// Built on glibc's __libc_* entry points, so it needs no dlsym bootstrap.
+// Compile the target with -rdynamic to get function names instead of offsets.
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <link.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void __libc_free(void *p);
+extern void *__libc_memalign(size_t align, size_t size);
+
+#define LEN(x) (sizeof(x)/sizeof((x)[0]))
+#define MAX_DEPTH 8
+#define SITE_BITS 14                 // 16384 call sites
+#define SITE_CAP (1u << SITE_BITS)
+#define SHARDS 64                    // live-block table shards (one lock each)
+#define SHARD_CAP 4096               // slots per shard, power of two
+#define FILTER_BITS 20               // counting filter in front of the live table
+#define NEW_SKIPS 16                 // learned operator new return addresses
+
+#define TLS __attribute__((tls_model("initial-exec")))
+
+struct site {
+    uint64_t key;                    // stack hash, 0 = free slot
+    void *frames[MAX_DEPTH];
+    uint64_t allocs, bytes, frees, lifetime_ns, short_lived;
+    uint64_t reallocs, small_grows, max_size;
+    int64_t live_bytes;
+};
+
+struct live {
+    uintptr_t ptr;                   // 0 = empty
+    uint32_t site;
+    size_t size;
+    uint64_t born_ns;
+};
+
+struct shard {
+    int lock;
+    unsigned count;
+    struct live slots[SHARD_CAP];
+};
+
+static struct site sites[SITE_CAP];
+static struct shard shards[SHARDS];
+static uint16_t maybe_live[1u << FILTER_BITS]; // tracked blocks per address hash
+static uint64_t dropped_sites, dropped_live;
+
+static unsigned cfg_sample = 1, cfg_depth = 1, cfg_top = 25;
+static uint64_t cfg_short_ns = 100000;
+static int report_fd = -1;                 // dup of fd 2 taken at startup
+
+// Return addresses inside operator new, and how many words above the slot
+// holding one the next return address sits (see new_probe())
+static struct { uintptr_t ret; unsigned dist; } new_skip[NEW_SKIPS];
+static unsigned nnew_skip;
+static bool new_probing;
+
+static TLS __thread int in_hook;           // reentrancy guard
+static TLS __thread long sample_left;
+static TLS __thread uint32_t sample_rng;  // 0 until the thread's first allocation
+static TLS __thread uintptr_t stack_lo, stack_hi; // stack_hi 0 = not looked up yet
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void spin_lock(int *l) {
+    while (__atomic_exchange_n(l, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(l, __ATOMIC_RELAXED)) __builtin_ia32_pause();
+    }
+}
+
+static void spin_unlock(int *l) { __atomic_store_n(l, 0, __ATOMIC_RELEASE); }
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33; x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static long sample_gap(void) {
+    uint32_t x = sample_rng;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    sample_rng = x;
+    return 1 + (long)(x % (2u * cfg_sample - 1));
+}
+
+// Cheap check on the hot path. With sampling, the next sampled call is
+// drawn uniformly from [1, 2N-1] so periodic allocation patterns don't alias.
+// A thread's first allocation draws its countdown instead of being sampled,
+// or every thread's first block (stdio buffers, ...) would be reported N times.
+static inline bool should_sample(void) {
+    if (in_hook) return false;
+    if (cfg_sample <= 1) return true;
+    if (__builtin_expect(!sample_rng, 0)) {
+        sample_rng = (uint32_t)mix64((uintptr_t)&sample_rng ^ now_ns()) | 1u;
+        sample_left = sample_gap();
+    }
+    if (--sample_left > 0) return false;
+    sample_left = sample_gap();
+    return true;
+}
+
+// The calling thread's stack, looked up once per thread. Runs inside the hook
+// (pthread_getattr_np may allocate). Empty range if unknown: no walk.
+static void stack_bounds(void) {
+    pthread_attr_t attr;
+    void *addr;
+    size_t size;
+    stack_lo = 0;
+    stack_hi = 1;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) return;
+    if (pthread_attr_getstack(&attr, &addr, &size) == 0) {
+        stack_lo = (uintptr_t)addr;
+        stack_hi = (uintptr_t)addr + size;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// Frame-pointer walk starting at the hook's own frame. fp[0] is the saved
+// caller fp, fp[1] the return address. Every frame must lie above the
+// previous one and inside the thread's stack, so a program built without
+// frame pointers yields wrong frames but never a fault.
+static unsigned capture(void **frames, void **fp, void *ra) {
+    unsigned n = 0;
+    for (void **slot = fp + 1; nnew_skip; ) { // fp[1] == ra
+        unsigned i = 0;
+        while (i < nnew_skip && new_skip[i].ret != (uintptr_t)*slot) ++i;
+        if (i == nnew_skip) break;
+        slot += new_skip[i].dist;
+        ra = *slot;
+    }
+    frames[n++] = ra;
+    if (cfg_depth == 1) return n;
+    if (!stack_hi) stack_bounds();
+    uintptr_t lo = stack_lo, hi = stack_hi;
+    if ((uintptr_t)fp < lo || (uintptr_t)fp + 2 * sizeof(void *) > hi) return n; // alternate stack
+    while (n < cfg_depth) {
+        uintptr_t next = (uintptr_t)fp[0];
+        if (next <= (uintptr_t)fp || next & 7 || next + 2 * sizeof(void *) > hi) break;
+        fp = (void **)next;
+        void *ret = fp[1];
+        if ((uintptr_t)ret < 0x10000) break; // rbp was not a frame pointer here
+        frames[n++] = ret;
+    }
+    return n;
+}
+
+static uint32_t site_get(void **frames, unsigned n) {
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    for (unsigned i = 0; i < n; ++i) h = mix64(h ^ (uint64_t)(uintptr_t)frames[i]);
+    if (!h) h = 1;
+    uint32_t idx = (uint32_t)h & (SITE_CAP - 1);
+    for (uint32_t probe = 0; probe < SITE_CAP; ++probe, idx = (idx + 1) & (SITE_CAP - 1)) {
+        uint64_t k = __atomic_load_n(&sites[idx].key, __ATOMIC_ACQUIRE);
+        if (k == h) return idx;
+        if (k == 0) {
+            uint64_t expected = 0;
+            if (__atomic_compare_exchange_n(&sites[idx].key, &expected, h, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                memcpy(sites[idx].frames, frames, n * sizeof *frames);
+                return idx;
+            }
+            if (expected == h) return idx;
+        }
+    }
+    __atomic_add_fetch(&dropped_sites, 1, __ATOMIC_RELAXED);
+    return UINT32_MAX;
+}
+
+static struct shard *shard_of(uintptr_t p) { return &shards[mix64(p) & (SHARDS - 1)]; }
+static uint16_t *filter_of(uintptr_t p) { return &maybe_live[(mix64(p) >> 8) & ((1u << FILTER_BITS) - 1)]; }
+static unsigned slot_of(uintptr_t p) { return (unsigned)(mix64(p) >> 32) & (SHARD_CAP - 1); }
+
+static void live_insert(uintptr_t p, uint32_t site, size_t size, uint64_t born) {
+    struct shard *s = shard_of(p);
+    spin_lock(&s->lock);
+    if (s->count >= SHARD_CAP * 3 / 4) {
+        spin_unlock(&s->lock);
+        __atomic_add_fetch(&dropped_live, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    unsigned i = slot_of(p);
+    while (s->slots[i].ptr) i = (i + 1) & (SHARD_CAP - 1);
+    s->slots[i] = (struct live){ p, site, size, born };
+    s->count++;
+    __atomic_add_fetch(filter_of(p), 1, __ATOMIC_RELAXED);
+    spin_unlock(&s->lock);
+}
+
+// Remove p if tracked; linear probing with backward-shift deletion so the
+// table never fills with tombstones. A zero filter count proves p untracked
+// without taking the lock: a block is only freed after its malloc returned,
+// so the insert's increment is visible to whoever frees it.
+static bool live_remove(uintptr_t p, struct live *out) {
+    if (__atomic_load_n(filter_of(p), __ATOMIC_RELAXED) == 0) return false;
+    struct shard *s = shard_of(p);
+    spin_lock(&s->lock);
+    unsigned i = slot_of(p);
+    while (s->slots[i].ptr && s->slots[i].ptr != p) i = (i + 1) & (SHARD_CAP - 1);
+    if (!s->slots[i].ptr) { spin_unlock(&s->lock); return false; }
+    *out = s->slots[i];
+    unsigned hole = i;
+    for (unsigned j = (i + 1) & (SHARD_CAP - 1); s->slots[j].ptr; j = (j + 1) & (SHARD_CAP - 1)) {
+        unsigned home = slot_of(s->slots[j].ptr);
+        // Move j into the hole unless its home lies cyclically in (hole, j]
+        bool stays = hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+        if (!stays) { s->slots[hole] = s->slots[j]; hole = j; }
+    }
+    s->slots[hole].ptr = 0;
+    s->count--;
+    __atomic_sub_fetch(filter_of(p), 1, __ATOMIC_RELAXED);
+    spin_unlock(&s->lock);
+    return true;
+}
+
+static void max_update(uint64_t *dst, uint64_t v) {
+    uint64_t cur = __atomic_load_n(dst, __ATOMIC_RELAXED);
+    while (v > cur && !__atomic_compare_exchange_n(dst, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+static void new_learn(void **fp);
+
+__attribute__((noinline))
+static void record_alloc(void *p, size_t size, void **fp, void *ra, bool is_realloc, size_t old_size) {
+    in_hook = 1;
+    if (__builtin_expect(new_probing, 0)) { new_learn(fp); in_hook = 0; return; }
+    void *frames[MAX_DEPTH];
+    unsigned n = capture(frames, fp, ra);
+    uint32_t idx = site_get(frames, n);
+    if (idx != UINT32_MAX) {
+        struct site *st = &sites[idx];
+        __atomic_add_fetch(&st->allocs, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&st->bytes, size, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&st->live_bytes, (int64_t)size, __ATOMIC_RELAXED);
+        max_update(&st->max_size, size);
+        if (is_realloc) {
+            __atomic_add_fetch(&st->reallocs, 1, __ATOMIC_RELAXED);
+            // Geometric growth never lands below 1.5x; small steps mean O(n^2) copying
+            if (size > old_size && size - old_size < old_size / 2)
+                __atomic_add_fetch(&st->small_grows, 1, __ATOMIC_RELAXED);
+        }
+        live_insert((uintptr_t)p, idx, size, now_ns());
+    }
+    in_hook = 0;
+}
+
+static void record_free(const struct live *l) {
+    struct site *st = &sites[l->site];
+    uint64_t life = now_ns() - l->born_ns;
+    __atomic_add_fetch(&st->frees, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&st->lifetime_ns, life, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&st->live_bytes, (int64_t)l->size, __ATOMIC_RELAXED);
+    if (life < cfg_short_ns) __atomic_add_fetch(&st->short_lived, 1, __ATOMIC_RELAXED);
+}
+
+// ---- Interposed entry points ----
+
+void *malloc(size_t size) {
+    void *p = __libc_malloc(size);
+    if (p && should_sample()) record_alloc(p, size, __builtin_frame_address(0), __builtin_return_address(0), false, 0);
+    return p;
+}
+
+void *calloc(size_t n, size_t size) {
+    void *p = __libc_calloc(n, size);
+    if (p && should_sample()) record_alloc(p, n * size, __builtin_frame_address(0), __builtin_return_address(0), false, 0);
+    return p;
+}
+
+void free(void *p) {
+    struct live l;
+    if (p && !in_hook && live_remove((uintptr_t)p, &l)) record_free(&l); // before the address can be reused
+    __libc_free(p);
+}
+
+void *realloc(void *old, size_t size) {
+    struct live l;
+    size_t old_size = 0;
+    bool tracked = old && !in_hook && live_remove((uintptr_t)old, &l);
+    if (tracked) { record_free(&l); old_size = l.size; }
+    void *p = __libc_realloc(old, size);
+    if (!p && old && size) {
+        // Failed: the old block is still allocated, keep tracking it
+        if (tracked) live_insert((uintptr_t)old, l.site, l.size, l.born_ns);
+        return NULL;
+    }
+    if (p && (tracked || should_sample()))
+        record_alloc(p, size, __builtin_frame_address(0), __builtin_return_address(0), old != NULL, old_size);
+    return p;
+}
+
+void *aligned_alloc(size_t align, size_t size) {
+    void *p = __libc_memalign(align, size);
+    if (p && should_sample()) record_alloc(p, size, __builtin_frame_address(0), __builtin_return_address(0), false, 0);
+    return p;
+}
+
+void *memalign(size_t align, size_t size) {
+    void *p = __libc_memalign(align, size);
+    if (p && should_sample()) record_alloc(p, size, __builtin_frame_address(0), __builtin_return_address(0), false, 0);
+    return p;
+}
+
+int posix_memalign(void **out, size_t align, size_t size) {
+    if (align < sizeof(void *) || (align & (align - 1))) return 22; // EINVAL
+    void *p = __libc_memalign(align, size);
+    if (!p) return 12; // ENOMEM
+    if (should_sample()) record_alloc(p, size, __builtin_frame_address(0), __builtin_return_address(0), false, 0);
+    *out = p;
+    return 0;
+}
+
+// ---- operator new ----
+//
+// libstdc++'s operator new keeps no frame pointer, so the return address the
+// hook sees is inside it and the caller's sits a few words further up the
+// stack, behind whatever operator new pushed. The distance is fixed per
+// return address: new_probe() calls every variant once from new_call() and
+// new_learn() measures it. Nothrow and new[] variants that call another one
+// just add a hop. A program without libstdc++ learns nothing.
+
+static const char *const new_names[] = {
+    "_Znwm", "_Znam", "_ZnwmRKSt9nothrow_t", "_ZnamRKSt9nothrow_t",
+    "_ZnwmSt11align_val_t", "_ZnamSt11align_val_t",
+    "_ZnwmSt11align_val_tRKSt9nothrow_t", "_ZnamSt11align_val_tRKSt9nothrow_t",
+};
+static uintptr_t new_lo[LEN(new_names)], new_hi[LEN(new_names)];
+
+static bool in_new(uintptr_t a) {
+    for (unsigned i = 0; i < LEN(new_names); ++i)
+        if (a >= new_lo[i] && a < new_hi[i]) return true;
+    return false;
+}
+
+// Never a tail call: the free() after the call keeps new_call's return
+// address on the stack, which is where the chain in new_learn() ends.
+__attribute__((noinline))
+static void new_call(void *fn, unsigned variant) {
+    static const char nothrow; // std::nothrow_t is an empty struct
+    void *p;
+    switch (variant / 2) {
+    case 0: p = ((void *(*)(size_t))fn)(16); break;
+    case 1: p = ((void *(*)(size_t, const void *))fn)(16, &nothrow); break;
+    case 2: p = ((void *(*)(size_t, size_t))fn)(16, 64); break;
+    default: p = ((void *(*)(size_t, size_t, const void *))fn)(16, 64, &nothrow); break;
+    }
+    free(p);
+}
+
+// Runs in the hook during new_probe(). fp[1] is the return address inside
+// operator new; each further word inside an operator new is the next hop,
+// and the first word inside new_call() is the probe's own call site.
+static void new_learn(void **fp) {
+    if (!in_new((uintptr_t)fp[1])) return; // operator new does not call us directly
+    unsigned prev = 1;
+    for (unsigned i = 2; i < 32; ++i) {
+        uintptr_t w = (uintptr_t)fp[i];
+        bool home = w - (uintptr_t)new_call < 256;
+        if (!home && !in_new(w)) continue;
+        unsigned k = 0;
+        while (k < nnew_skip && new_skip[k].ret != (uintptr_t)fp[prev]) ++k;
+        if (k == nnew_skip && k < NEW_SKIPS) {
+            new_skip[k].ret = (uintptr_t)fp[prev];
+            new_skip[k].dist = i - prev;
+            nnew_skip++;
+        }
+        if (home) return;
+        prev = i;
+    }
+}
+
+static void new_probe(void) {
+    void *fns[LEN(new_names)];
+    in_hook = 1; // a failed dlsym allocates its error message
+    for (unsigned i = 0; i < LEN(new_names); ++i) {
+        Dl_info info;
+        const ElfW(Sym) *sym = NULL;
+        fns[i] = dlsym(RTLD_DEFAULT, new_names[i]);
+        if (fns[i] && dladdr1(fns[i], &info, (void **)&sym, RTLD_DL_SYMENT) && sym) {
+            new_lo[i] = (uintptr_t)fns[i];
+            new_hi[i] = (uintptr_t)fns[i] + sym->st_size;
+        }
+    }
+    in_hook = 0;
+    new_probing = true;
+    for (unsigned i = 0; i < LEN(new_names); ++i)
+        if (new_hi[i]) new_call(fns[i], i);
+    new_probing = false;
+}
+
+// ---- Configuration and report ----
+
+static unsigned env_uint(const char *name, unsigned def, unsigned lo, unsigned hi) {
+    const char *s = getenv(name);
+    if (!s || !*s) return def;
+    char *end = NULL;
+    unsigned long v = strtoul(s, &end, 10);
+    if (*end || v < lo || v > hi) return def;
+    return (unsigned)v;
+}
+
+__attribute__((constructor))
+static void allocprof_init(void) {
+    new_probe(); // first: with sampling configured, some probes would be skipped
+    in_hook = 1;
+    report_fd = fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 3);
+    cfg_sample = env_uint("ALLOCPROF_SAMPLE", 1, 1, 1u << 30);
+    cfg_depth = env_uint("ALLOCPROF_DEPTH", 1, 1, MAX_DEPTH);
+    cfg_top = env_uint("ALLOCPROF_TOP", 25, 1, SITE_CAP);
+    cfg_short_ns = (uint64_t)env_uint("ALLOCPROF_SHORT_US", 100, 1, 1u << 30) * 1000u;
+    in_hook = 0;
+}
+
+static uint32_t order[SITE_CAP];
+
+static int cmp_bytes_desc(const void *a, const void *b) {
+    uint64_t x = sites[*(const uint32_t *)a].bytes, y = sites[*(const uint32_t *)b].bytes;
+    return (x < y) - (x > y);
+}
+
+static void describe(FILE *out, void *addr) {
+    Dl_info info;
+    if (dladdr(addr, &info) && info.dli_fname) {
+        const char *mod = strrchr(info.dli_fname, '/');
+        mod = mod ? mod + 1 : info.dli_fname;
+        if (info.dli_sname)
+            fprintf(out, "%s+0x%lx (%s)", info.dli_sname, (unsigned long)((char *)addr - (char *)info.dli_saddr), mod);
+        else
+            fprintf(out, "%s+0x%lx", mod, (unsigned long)((char *)addr - (char *)info.dli_fbase));
+    } else {
+        fprintf(out, "%p", addr);
+    }
+}
+
+__attribute__((destructor))
+static void allocprof_report(void) {
+    in_hook = 1; // allocations made while reporting are not profiled
+    FILE *out = NULL;
+    const char *path = getenv("ALLOCPROF_OUT");
+    if (path && *path) out = fopen(path, "w");
+    if (!out && report_fd >= 0) out = fdopen(report_fd, "w");
+    if (!out) out = stderr;
+
+    uint32_t n = 0;
+    uint64_t allocs = 0, bytes = 0;
+    for (uint32_t i = 0; i < SITE_CAP; ++i) {
+        if (!sites[i].key || !sites[i].allocs) continue;
+        order[n++] = i;
+        allocs += sites[i].allocs;
+        bytes += sites[i].bytes;
+    }
+    qsort(order, n, sizeof order[0], cmp_bytes_desc);
+
+    unsigned scale = cfg_sample;
+    fprintf(out, "\n== allocprof: %s%llu allocations, %s%llu bytes, %u sites (sample 1/%u, depth %u) ==\n",
+            scale > 1 ? "~" : "", (unsigned long long)allocs * scale,
+            scale > 1 ? "~" : "", (unsigned long long)bytes * scale, n, scale, cfg_depth);
+    if (dropped_sites || dropped_live)
+        fprintf(out, "   (table full: %llu allocations without site, %llu not tracked for lifetime)\n",
+                (unsigned long long)dropped_sites, (unsigned long long)dropped_live);
+    fprintf(out, "%5s %12s %10s %10s %10s %8s  %s\n", "rank", "bytes", "allocs", "avg size", "avg life", "hints", "site");
+
+    for (uint32_t r = 0; r < n && r < cfg_top; ++r) {
+        const struct site *s = &sites[order[r]];
+        char hints[32] = "";
+        if (s->allocs >= 16 && s->short_lived * 2 >= s->allocs) strcat(hints, "arena? ");
+        if (s->small_grows >= 8) strcat(hints, "regrow ");
+        if (s->live_bytes > 0) strcat(hints, "live");
+        double avg_life_us = s->frees ? (double)s->lifetime_ns / (double)s->frees / 1e3 : 0.0;
+        fprintf(out, "%5u %12llu %10llu %10llu %8.1fus %8s  ", r + 1,
+                (unsigned long long)s->bytes * scale, (unsigned long long)s->allocs * scale,
+                (unsigned long long)(s->bytes / s->allocs), avg_life_us, hints);
+        for (unsigned d = 0; d < MAX_DEPTH && s->frames[d]; ++d) {
+            if (d) fprintf(out, " <- ");
+            describe(out, s->frames[d]);
+        }
+        fprintf(out, "\n");
+        if (s->small_grows >= 8)
+            fprintf(out, "      %llu of %llu reallocs grew by <1.5x (max %llu bytes): reserve up front or grow geometrically\n",
+                    (unsigned long long)s->small_grows * scale, (unsigned long long)s->reallocs * scale,
+                    (unsigned long long)s->max_size);
+        if (s->allocs >= 16 && s->short_lived * 2 >= s->allocs)
+            fprintf(out, "      %llu%% freed within %lluus: candidate for an arena or stack buffer\n",
+                    (unsigned long long)(s->short_lived * 100 / s->allocs), (unsigned long long)cfg_short_ns / 1000);
+    }
+    if (out != stderr) fclose(out);
+}
@@ -0,0 +1,179 @@
+// Build: gcc -O2 bitvec.c -o build/bitvec
+// Usage: build/bitvec [nbits]   (default 200M)
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bitvec.h"
+
+// ---- Demos ----
+
+static void basics_demo(void) {
+    struct bitvec a, b, c;
+    if (!bv_init(&a, 100) || !bv_init(&b, 100) || !bv_init(&c, 100)) { perror("bv_init"); return; }
+    for (size_t i = 0; i < 100; i += 2) bv_set(&a, i);   // the is_even ids
+    for (size_t i = 0; i < 100; i += 3) bv_set(&b, i);   // multiples of 3
+    bv_and(&c, &a, &b);
+    printf("even & mult3: %llu ids:", (unsigned long long)bv_count(&c));
+    struct bv_iter it;
+    size_t pos;
+    bv_iter_init(&it, &c);
+    while (bv_next(&it, &pos)) printf(" %zu", pos);
+    putchar('\n');
+    bv_or(&c, &a, &b);
+    printf("even | mult3: %llu, ", (unsigned long long)bv_count(&c));
+    bv_xor(&c, &a, &b);
+    printf("even ^ mult3: %llu, ", (unsigned long long)bv_count(&c));
+    bv_andnot(&c, &a, &b);
+    printf("even & ~mult3: %llu\n", (unsigned long long)bv_count(&c));
+
+    bv_build_index(&b);
+    printf("mult3: rank(50)=%llu (ones below 50), select(10)=%zu (11th one)\n",
+           (unsigned long long)bv_rank(&b, 50), bv_select(&b, 10));
+    bv_free(&a);
+    bv_free(&b);
+    bv_free(&c);
+}
+
+// ---- Benchmark ----
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x2545f4914f6cdd1dull;
+static uint64_t rng(void) {
+    uint64_t x = rng_state;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return rng_state = x;
+}
+
+static void bench(size_t n) {
+    bool *fa = calloc(n, 1), *fb = calloc(n, 1), *fc = malloc(n);
+    struct bitvec a, b, c;
+    bool have = bv_init(&a, n) && bv_init(&b, n) && bv_init(&c, n);
+    if (!fa || !fb || !fc || !have) { perror("alloc"); goto out; }
+
+    // ~10% and ~50% dense membership sets
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t r = rng();
+        fa[i] = (r & 1023) < 102;
+        fb[i] = (r >> 32 & 1);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (fa[i]) bv_set(&a, i);
+        if (fb[i]) bv_set(&b, i);
+    }
+    double t0 = now_sec();
+    if (!bv_build_index(&a)) { perror("bv_build_index"); goto out; }
+    double t_index = now_sec() - t0;
+
+    printf("%zu ids: bool[] %.1f MB, bitvec %.1f MB (+%.1f MB rank/select index, built in %.1f ms)\n", n,
+           n / 1e6, a.nwords * 8 / 1e6, (bv_bytes(&a) - a.nwords * 8) / 1e6, t_index * 1e3);
+
+    const int reps = 5;
+    uint64_t cb = 0, cv = 0;
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) for (size_t i = 0; i < n; ++i) cb += fa[i];
+    double t_b = now_sec() - t0;
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) cv += bv_count(&a);
+    double t_v = now_sec() - t0;
+    printf("count:       bool %7.2f ms  bitvec %7.2f ms  (%.0fx) %s\n", t_b * 1e3 / reps, t_v * 1e3 / reps,
+           t_b / t_v, cb == cv ? "ok" : "MISMATCH");
+
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) for (size_t i = 0; i < n; ++i) fc[i] = fa[i] & !fb[i];
+    t_b = now_sec() - t0;
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) bv_andnot(&c, &a, &b);
+    t_v = now_sec() - t0;
+    cb = 0;
+    for (size_t i = 0; i < n; ++i) cb += fc[i];
+    printf("a & ~b:      bool %7.2f ms  bitvec %7.2f ms  (%.0fx) %s\n", t_b * 1e3 / reps, t_v * 1e3 / reps,
+           t_b / t_v, cb == bv_count(&c) ? "ok" : "MISMATCH");
+
+    // Visit every member
+    uint64_t sb = 0, sv = 0;
+    t0 = now_sec();
+    for (size_t i = 0; i < n; ++i) if (fa[i]) sb += i;
+    t_b = now_sec() - t0;
+    t0 = now_sec();
+    struct bv_iter it;
+    size_t pos;
+    bv_iter_init(&it, &a);
+    while (bv_next(&it, &pos)) sv += pos;
+    t_v = now_sec() - t0;
+    printf("iterate:     bool %7.2f ms  bitvec %7.2f ms  (%.0fx) %s\n", t_b * 1e3, t_v * 1e3, t_b / t_v,
+           sb == sv ? "ok" : "MISMATCH");
+
+    // rank/select against prefix counts taken from the bool array
+    const size_t step = 4096, q = 1000000;
+    size_t np = n / step + 1;
+    uint64_t *prefix = malloc(np * sizeof *prefix);
+    size_t *qpos = malloc(q * sizeof *qpos);
+    if (!prefix || !qpos) { perror("malloc"); free(prefix); free(qpos); goto out; }
+    uint64_t acc = 0;
+    for (size_t i = 0; i < n; ++i) { if (i % step == 0) prefix[i / step] = acc; acc += fa[i]; }
+    for (size_t i = 0; i < q; ++i) qpos[i] = (size_t)(rng() % n);
+    uint64_t *qk = malloc(q * sizeof *qk);
+    if (!qk) { perror("malloc"); free(prefix); free(qpos); goto out; }
+    for (size_t i = 0; i < q; ++i) qk[i] = a.ones ? rng() % a.ones : 0;
+
+    bool ok = true;
+    for (size_t i = 0; i < 2000; ++i) {
+        size_t p = qpos[i];
+        uint64_t want = prefix[p / step];
+        for (size_t j = p / step * step; j < p; ++j) want += fa[j];
+        ok &= bv_rank(&a, p) == want;
+        if (a.ones) {
+            uint64_t k = rng() % a.ones;
+            size_t s = bv_select(&a, k);
+            ok &= bv_get(&a, s) && bv_rank(&a, s) == k;
+        }
+    }
+    ok &= bv_rank(&a, n) == a.ones;
+    uint64_t sink = 0;
+    t0 = now_sec();
+    for (size_t i = 0; i < q; ++i) sink += bv_rank(&a, qpos[i]);
+    double t_rank = now_sec() - t0;
+    t0 = now_sec();
+    for (size_t i = 0; i < q && a.ones; ++i) sink += bv_select(&a, qk[i]);
+    double t_sel = now_sec() - t0;
+    printf("rank %.1f ns, select %.1f ns per random query (bool[] would scan) %s (sink %llu)\n",
+           t_rank * 1e9 / q, t_sel * 1e9 / q, ok ? "ok" : "MISMATCH", (unsigned long long)(sink & 0xff));
+
+    uint32_t *out32 = malloc(a.ones * sizeof *out32);
+    if (out32) {
+        t0 = now_sec();
+        size_t got = bv_positions(&a, out32);
+        double t_pos = now_sec() - t0;
+        printf("bv_positions: %zu ids in %.2f ms %s\n", got, t_pos * 1e3,
+               got == a.ones && (!got || bv_select(&a, got - 1) == out32[got - 1]) ? "ok" : "MISMATCH");
+        free(out32);
+    }
+    free(prefix);
+    free(qpos);
+    free(qk);
+out:
+    free(fa); free(fb); free(fc);
+    bv_free(&a); bv_free(&b); bv_free(&c);
+}
+
+int main(int argc, char **argv) {
+    bv_kernels_init();
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000000;
+    if (!n || n > UINT32_MAX) n = 200000000;
+
+    puts("-- Bitvector --");
+    basics_demo();
+
+    printf("\n-- Benchmark (level %s) --\n", cpu_level_name(cpu_info()->level));
+    bench(n);
+    return 0;
+}
@@ -0,0 +1,338 @@
+#ifndef BITVEC_H
+#define BITVEC_H
+
+// Bitvector for large membership sets: one bit per id, stored in 64-bit
+// words, so set operations and counts run a word (or a 256-bit vector) at a
+// time instead of a byte per id as with a bool array.
+//
+// rank(i) (ones before position i) and select(k) (position of the k-th one)
+// use a rank9 index built by bv_build_index(): per 512-bit block, one word
+// with the ones before the block and one word packing seven 9-bit counts for
+// the words inside it (25% extra space). rank is two lookups and a popcount.
+// select starts from a sample taken every BV_SELECT_SAMPLE ones, binary
+// searches the few blocks between samples and finishes inside one word.
+// The index describes the bits at build time; rebuild it after changes.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cpuprobe.h"
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+#define BV_BLOCK_WORDS 8           // 512-bit rank block
+#define BV_SELECT_SAMPLE 512
+#define BV_ALIGN 64
+
+struct bitvec {
+    uint64_t *words;       // padding bits past nbits are always zero
+    size_t nbits;
+    size_t nwords;         // multiple of BV_BLOCK_WORDS
+    uint64_t ones;         // valid after bv_build_index
+    uint64_t *counts;      // 2 per block + sentinel pair
+    uint64_t *samples;     // block holding the (j * BV_SELECT_SAMPLE)-th one
+    size_t nsamples;
+};
+
+static inline bool bv_init(struct bitvec *bv, size_t nbits) {
+    memset(bv, 0, sizeof *bv);
+    size_t nwords = (nbits + 63) / 64;
+    nwords = (nwords + BV_BLOCK_WORDS - 1) / BV_BLOCK_WORDS * BV_BLOCK_WORDS;
+    if (!nwords) nwords = BV_BLOCK_WORDS;
+    bv->words = (uint64_t *)aligned_alloc(BV_ALIGN, nwords * sizeof *bv->words);
+    if (!bv->words) return false;
+    memset(bv->words, 0, nwords * sizeof *bv->words);
+    bv->nbits = nbits;
+    bv->nwords = nwords;
+    return true;
+}
+
+static inline void bv_free(struct bitvec *bv) {
+    free(bv->words);
+    free(bv->counts);
+    free(bv->samples);
+    memset(bv, 0, sizeof *bv);
+}
+
+static inline size_t bv_bytes(const struct bitvec *bv) {
+    size_t nblocks = bv->nwords / BV_BLOCK_WORDS;
+    return bv->nwords * 8 + (bv->counts ? (nblocks + 1) * 16 : 0) + bv->nsamples * 8;
+}
+
+static inline bool bv_get(const struct bitvec *bv, size_t i) { return bv->words[i / 64] >> (i % 64) & 1; }
+static inline void bv_set(struct bitvec *bv, size_t i) { bv->words[i / 64] |= 1ull << (i % 64); }
+static inline void bv_reset(struct bitvec *bv, size_t i) { bv->words[i / 64] &= ~(1ull << (i % 64)); }
+
+// ---- Popcount over a word range ----
+
+static inline uint64_t bv_count_scalar(const uint64_t *w, size_t n) {
+    uint64_t c = 0;
+    for (size_t i = 0; i < n; ++i) c += (uint64_t)__builtin_popcountll(w[i]);
+    return c;
+}
+
+#ifdef CPU_X86
+CPU_TARGET_SSE42
+static inline uint64_t bv_count_popcnt(const uint64_t *w, size_t n) {
+    uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0; // independent chains hide popcnt latency
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c0 += (uint64_t)_mm_popcnt_u64(w[i]);
+        c1 += (uint64_t)_mm_popcnt_u64(w[i + 1]);
+        c2 += (uint64_t)_mm_popcnt_u64(w[i + 2]);
+        c3 += (uint64_t)_mm_popcnt_u64(w[i + 3]);
+    }
+    for (; i < n; ++i) c0 += (uint64_t)_mm_popcnt_u64(w[i]);
+    return c0 + c1 + c2 + c3;
+}
+
+// Nibble lookup with vpshufb, summed per 64-bit lane with vpsadbw.
+CPU_TARGET_AVX2
+static inline uint64_t bv_count_avx2(const uint64_t *w, size_t n) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(w + i));
+        __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, low)),
+                                    _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+    }
+    uint64_t c = (uint64_t)_mm256_extract_epi64(acc, 0) + (uint64_t)_mm256_extract_epi64(acc, 1) +
+                 (uint64_t)_mm256_extract_epi64(acc, 2) + (uint64_t)_mm256_extract_epi64(acc, 3);
+    for (; i < n; ++i) c += (uint64_t)_mm_popcnt_u64(w[i]);
+    return c;
+}
+#endif
+
+// ---- Set operations: dst = a OP b, word-parallel ----
+
+enum bv_op { BV_AND, BV_OR, BV_XOR, BV_ANDNOT };
+
+static inline void bv_op_scalar(enum bv_op op, uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n) {
+    switch (op) {
+        case BV_AND:    for (size_t i = 0; i < n; ++i) dst[i] = a[i] & b[i]; break;
+        case BV_OR:     for (size_t i = 0; i < n; ++i) dst[i] = a[i] | b[i]; break;
+        case BV_XOR:    for (size_t i = 0; i < n; ++i) dst[i] = a[i] ^ b[i]; break;
+        case BV_ANDNOT: for (size_t i = 0; i < n; ++i) dst[i] = a[i] & ~b[i]; break;
+    }
+}
+
+#ifdef CPU_X86
+CPU_TARGET_AVX2
+static inline void bv_op_avx2(enum bv_op op, uint64_t *dst, const uint64_t *a, const uint64_t *b, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i r;
+        switch (op) {
+            case BV_AND:    r = _mm256_and_si256(x, y); break;
+            case BV_OR:     r = _mm256_or_si256(x, y); break;
+            case BV_XOR:    r = _mm256_xor_si256(x, y); break;
+            default:        r = _mm256_andnot_si256(y, x); break;
+        }
+        _mm256_storeu_si256((__m256i *)(dst + i), r);
+    }
+    bv_op_scalar(op, dst + i, a + i, b + i, n - i);
+}
+#endif
+
+// ---- rank / select ----
+
+// Ones in the block before word `off` (0..7) of that block.
+static inline uint64_t bv_block_rel(const uint64_t *counts, size_t block, unsigned off) {
+    return counts[2 * block + 1] >> (63 - 9 * off) & 0x1ff;
+}
+
+static inline __attribute__((always_inline)) uint64_t bv_rank_impl(const struct bitvec *bv, size_t i) {
+    if (i >= bv->nbits) return bv->ones;
+    size_t word = i / 64, block = word / BV_BLOCK_WORDS;
+    return bv->counts[2 * block] + bv_block_rel(bv->counts, block, word % BV_BLOCK_WORDS) +
+           (uint64_t)__builtin_popcountll(bv->words[word] & ((1ull << (i % 64)) - 1));
+}
+
+// Position of the r-th (0-based) set bit of w; w has more than r ones.
+static inline unsigned bv_select_word_scalar(uint64_t w, unsigned r) {
+    for (unsigned byte = 0;; ++byte, w >>= 8) {
+        unsigned c = (unsigned)__builtin_popcountll(w & 0xff);
+        if (r < c) {
+            for (; r; --r) w &= w - 1;
+            return byte * 8 + (unsigned)__builtin_ctzll(w);
+        }
+        r -= c;
+    }
+}
+
+#ifdef CPU_X86
+// pdep deposits a single 1 at the r-th set bit of w
+CPU_TARGET_AVX2
+static inline unsigned bv_select_word_bmi2(uint64_t w, unsigned r) {
+    return (unsigned)_tzcnt_u64(_pdep_u64(1ull << r, w));
+}
+#endif
+
+// k < ones. The select_word argument is a constant, so each wrapper below
+// gets its own inlined copy.
+static inline __attribute__((always_inline))
+size_t bv_select_impl(const struct bitvec *bv, uint64_t k, unsigned (*select_word)(uint64_t, unsigned)) {
+    size_t nblocks = bv->nwords / BV_BLOCK_WORDS;
+    size_t s = (size_t)(k / BV_SELECT_SAMPLE);
+    size_t lo = bv->samples[s], hi = s + 1 < bv->nsamples ? bv->samples[s + 1] + 1 : nblocks;
+    while (hi - lo > 1) { // last block in [lo, hi) whose preceding count is <= k; cmov, no branch
+        size_t mid = lo + (hi - lo) / 2;
+        bool le = bv->counts[2 * mid] <= k;
+        lo = le ? mid : lo;
+        hi = le ? hi : mid;
+    }
+    uint64_t rel = k - bv->counts[2 * lo];
+    unsigned off = 0; // the in-block counts are sorted: count those <= rel
+    for (unsigned j = 1; j < BV_BLOCK_WORDS; ++j) off += bv_block_rel(bv->counts, lo, j) <= rel;
+    size_t word = lo * BV_BLOCK_WORDS + off;
+    return word * 64 + select_word(bv->words[word], (unsigned)(rel - bv_block_rel(bv->counts, lo, off)));
+}
+
+static inline uint64_t bv_rank_scalar(const struct bitvec *bv, size_t i) { return bv_rank_impl(bv, i); }
+static inline size_t bv_select_scalar(const struct bitvec *bv, uint64_t k) { return bv_select_impl(bv, k, bv_select_word_scalar); }
+
+#ifdef CPU_X86
+CPU_TARGET_SSE42
+static inline uint64_t bv_rank_popcnt(const struct bitvec *bv, size_t i) { return bv_rank_impl(bv, i); }
+CPU_TARGET_SSE42
+static inline size_t bv_select_popcnt(const struct bitvec *bv, uint64_t k) { return bv_select_impl(bv, k, bv_select_word_scalar); }
+CPU_TARGET_AVX2
+static inline size_t bv_select_bmi2(const struct bitvec *bv, uint64_t k) { return bv_select_impl(bv, k, bv_select_word_bmi2); }
+#endif
+
+// ---- Dispatch, resolved once ----
+
+typedef uint64_t (*bv_count_fn)(const uint64_t *, size_t);
+typedef void (*bv_op_fn)(enum bv_op, uint64_t *, const uint64_t *, const uint64_t *, size_t);
+typedef uint64_t (*bv_rank_fn)(const struct bitvec *, size_t);
+typedef size_t (*bv_select_fn)(const struct bitvec *, uint64_t);
+
+// Positional initializers, one slot per level, for C++ builds.
+static const bv_count_fn bv_count_table[CPU_LEVEL_COUNT] = {
+    bv_count_scalar,     // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    bv_count_popcnt,     // CPU_LEVEL_SSE42
+    bv_count_avx2,       // CPU_LEVEL_AVX2
+#endif
+};
+static const bv_op_fn bv_op_table[CPU_LEVEL_COUNT] = {
+    bv_op_scalar,        // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                // CPU_LEVEL_SSE42
+    bv_op_avx2,          // CPU_LEVEL_AVX2
+#endif
+};
+static const bv_rank_fn bv_rank_table[CPU_LEVEL_COUNT] = {
+    bv_rank_scalar,      // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    bv_rank_popcnt,      // CPU_LEVEL_SSE42
+#endif
+};
+static const bv_select_fn bv_select_table[CPU_LEVEL_COUNT] = {
+    bv_select_scalar,    // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    bv_select_popcnt,    // CPU_LEVEL_SSE42
+    bv_select_bmi2,      // CPU_LEVEL_AVX2
+#endif
+};
+
+// Kernels in use; scalar until bv_kernels_init() picks the CPU's best.
+static bv_count_fn bv_count_words = bv_count_scalar;
+static bv_op_fn bv_op_words = bv_op_scalar;
+static bv_rank_fn bv_rank = bv_rank_scalar;          // ones in [0, i)
+static bv_select_fn bv_select = bv_select_scalar;    // position of the k-th one (0-based), k < ones
+
+static inline void bv_kernels_init(void) {
+    CPU_DISPATCH(bv_count_words, bv_count_table);
+    CPU_DISPATCH(bv_op_words, bv_op_table);
+    CPU_DISPATCH(bv_rank, bv_rank_table);
+    CPU_DISPATCH(bv_select, bv_select_table);
+}
+
+static inline uint64_t bv_count(const struct bitvec *bv) { return bv_count_words(bv->words, bv->nwords); }
+
+// dst may be a or b; all three must have the same size.
+static inline void bv_and(struct bitvec *dst, const struct bitvec *a, const struct bitvec *b) { bv_op_words(BV_AND, dst->words, a->words, b->words, dst->nwords); }
+static inline void bv_or(struct bitvec *dst, const struct bitvec *a, const struct bitvec *b) { bv_op_words(BV_OR, dst->words, a->words, b->words, dst->nwords); }
+static inline void bv_xor(struct bitvec *dst, const struct bitvec *a, const struct bitvec *b) { bv_op_words(BV_XOR, dst->words, a->words, b->words, dst->nwords); }
+static inline void bv_andnot(struct bitvec *dst, const struct bitvec *a, const struct bitvec *b) { bv_op_words(BV_ANDNOT, dst->words, a->words, b->words, dst->nwords); }
+
+static inline bool bv_build_index(struct bitvec *bv) {
+    size_t nblocks = bv->nwords / BV_BLOCK_WORDS;
+    uint64_t *counts = (uint64_t *)realloc(bv->counts, (nblocks + 1) * 2 * sizeof *counts);
+    if (!counts) return false;
+    bv->counts = counts;
+
+    uint64_t total = 0;
+    for (size_t b = 0; b < nblocks; ++b) {
+        const uint64_t *w = bv->words + b * BV_BLOCK_WORDS;
+        uint64_t packed = 0, rel = 0;
+        for (unsigned j = 0; j < BV_BLOCK_WORDS; ++j) {
+            if (j) packed |= rel << (63 - 9 * j);
+            rel += bv_count_words(w + j, 1);
+        }
+        counts[2 * b] = total;
+        counts[2 * b + 1] = packed;
+        total += rel;
+    }
+    counts[2 * nblocks] = total;
+    counts[2 * nblocks + 1] = 0;
+    bv->ones = total;
+
+    size_t nsamples = (size_t)((total + BV_SELECT_SAMPLE - 1) / BV_SELECT_SAMPLE);
+    uint64_t *samples = (uint64_t *)realloc(bv->samples, (nsamples ? nsamples : 1) * sizeof *samples);
+    if (!samples) return false;
+    bv->samples = samples;
+    bv->nsamples = nsamples;
+    size_t s = 0;
+    for (size_t b = 0; b < nblocks && s < nsamples; ++b) {
+        while (s < nsamples && (uint64_t)s * BV_SELECT_SAMPLE < counts[2 * b + 2]) samples[s++] = b;
+    }
+    return true;
+}
+
+// ---- Iteration over set bits ----
+
+struct bv_iter {
+    const uint64_t *words;
+    size_t nwords, wi;
+    uint64_t cur;          // bits of words[wi] not yet returned
+};
+
+static inline void bv_iter_init(struct bv_iter *it, const struct bitvec *bv) {
+    it->words = bv->words;
+    it->nwords = bv->nwords;
+    it->wi = 0;
+    it->cur = bv->words[0];
+}
+
+// Next set position in increasing order; false when exhausted.
+static inline bool bv_next(struct bv_iter *it, size_t *pos) {
+    while (!it->cur) {
+        if (++it->wi >= it->nwords) return false;
+        it->cur = it->words[it->wi];
+    }
+    *pos = it->wi * 64 + (size_t)__builtin_ctzll(it->cur); // tzcnt/bsf
+    it->cur &= it->cur - 1;                                 // clear lowest set bit
+    return true;
+}
+
+// Write all set positions to out (room for bv_count() entries); returns how many.
+static inline size_t bv_positions(const struct bitvec *bv, uint32_t *out) {
+    size_t n = 0;
+    for (size_t i = 0; i < bv->nwords; ++i) {
+        for (uint64_t w = bv->words[i]; w; w &= w - 1) out[n++] = (uint32_t)(i * 64 + (size_t)__builtin_ctzll(w));
+    }
+    return n;
+}
+
+#endif // BITVEC_H
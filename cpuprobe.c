@@ -0,0 +1,154 @@
+// Build: gcc -O2 cpuprobe.c -o build/cpuprobe
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "cpuprobe.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void print_size(const char *label, const struct cpu_cache *c) {
+    if (!c->size) { printf("%-4s: (unknown)\n", label); return; }
+    printf("%-4s: %6zu KiB, line %u B, %u-way, shared by %u cpu(s)\n",
+           label, c->size >> 10, c->line, c->ways, c->shared_cpus);
+}
+
+// Features, caches and topology as seen by the probe
+static void probe_report(void) {
+    const struct cpu_info *ci = cpu_info();
+    printf("vendor: %s\nbrand:  %s\n", ci->vendor, ci->brand);
+    printf("sse2=%d sse4.2=%d popcnt=%d avx=%d avx2=%d fma=%d bmi1=%d bmi2=%d lzcnt=%d\n",
+           ci->sse2, ci->sse42, ci->popcnt, ci->avx, ci->avx2, ci->fma,
+           ci->bmi1, ci->bmi2, ci->lzcnt);
+    printf("avx512f=%d avx512bw=%d avx512vl=%d avx512dq=%d avx512vpopcntdq=%d\n",
+           ci->avx512f, ci->avx512bw, ci->avx512vl, ci->avx512dq, ci->avx512vpopcntdq);
+    printf("dispatch level: %s (cap with CPU_LEVEL=scalar|sse4.2|avx2|avx512)\n",
+           cpu_level_name(ci->level));
+
+    puts("\n-- Caches --");
+    print_size("L1d", &ci->l1d);
+    print_size("L1i", &ci->l1i);
+    print_size("L2", &ci->l2);
+    print_size("L3", &ci->l3);
+    printf("cache line: %u bytes\n", ci->line_size);
+
+    puts("\n-- Topology --");
+    printf("logical cpus: %u, physical cores: %u, packages: %u, NUMA nodes: %u\n",
+           ci->logical_cpus, ci->physical_cores, ci->packages, ci->numa_nodes);
+}
+
+// One kernel, several variants: sum of int32 into int64
+static int64_t sum_i32_scalar(const int32_t *a, size_t n) {
+    int64_t s = 0;
+    for (size_t i = 0; i < n; ++i) s += a[i];
+    return s;
+}
+
+#ifdef CPU_X86
+CPU_TARGET_SSE42
+static int64_t sum_i32_sse42(const int32_t *a, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(a + i));
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(v));
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+    }
+    int64_t s = _mm_extract_epi64(acc, 0) + _mm_extract_epi64(acc, 1);
+    for (; i < n; ++i) s += a[i];
+    return s;
+}
+
+CPU_TARGET_AVX2
+static int64_t sum_i32_avx2(const int32_t *a, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(a + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i r = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    int64_t s = _mm_extract_epi64(r, 0) + _mm_extract_epi64(r, 1);
+    for (; i < n; ++i) s += a[i];
+    return s;
+}
+
+CPU_TARGET_AVX512
+static int64_t sum_i32_avx512(const int32_t *a, size_t n) {
+    __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void *)(a + i));
+        acc0 = _mm512_add_epi64(acc0, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+        acc1 = _mm512_add_epi64(acc1, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    int64_t s = _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1));
+    for (; i < n; ++i) s += a[i];
+    return s;
+}
+#endif
+
+typedef int64_t (*sum_i32_fn)(const int32_t *, size_t);
+
+// Dispatch table indexed by enum cpu_level; missing variants stay NULL
+static const sum_i32_fn sum_i32_table[CPU_LEVEL_COUNT] = {
+    [CPU_LEVEL_SCALAR] = sum_i32_scalar,
+#ifdef CPU_X86
+    [CPU_LEVEL_SSE42]  = sum_i32_sse42,
+    [CPU_LEVEL_AVX2]   = sum_i32_avx2,
+    [CPU_LEVEL_AVX512] = sum_i32_avx512,
+#endif
+};
+
+// Resolved once at startup; callers go through the pointer with no checks
+static sum_i32_fn sum_i32;
+
+static void kernels_init(void) {
+    CPU_DISPATCH(sum_i32, sum_i32_table);
+}
+
+static void dispatch_demo(void) {
+    size_t n = (size_t)1 << 22;
+    int32_t *a = malloc(n * sizeof *a);
+    if (!a) { perror("malloc"); return; }
+    for (size_t i = 0; i < n; ++i) a[i] = (int32_t)((i * 2654435761u) >> 8) - (1 << 22);
+
+    printf("selected kernel: %s\n", cpu_level_name(cpu_info()->level));
+    int64_t expect = sum_i32_scalar(a, n);
+    int reps = 50;
+    for (int lvl = 0; lvl <= (int)cpu_info()->level; ++lvl) {
+        sum_i32_fn fn = sum_i32_table[lvl];
+        if (!fn) continue;
+        int64_t s = 0;
+        double t0 = now_sec();
+        for (int r = 0; r < reps; ++r) s += fn(a, n);
+        double dt = now_sec() - t0;
+        printf("%-7s: %6.2f GB/s %s\n", cpu_level_name((enum cpu_level)lvl),
+               (double)n * sizeof *a * reps / dt / 1e9,
+               s == expect * reps ? "ok" : "MISMATCH");
+    }
+    printf("sum_i32 via table = %lld\n", (long long)sum_i32(a, n));
+    free(a);
+}
+
+int main(void) {
+    kernels_init();
+
+    puts("-- CPU Features --");
+    probe_report();
+
+    puts("\n-- Dispatch Table --");
+    dispatch_demo();
+
+    return 0;
+}
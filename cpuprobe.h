@@ -0,0 +1,329 @@
+#ifndef CPUPROBE_H
+#define CPUPROBE_H
+
+// Header-only runtime probe of the machine we run on: SIMD features via cpuid,
+// cache sizes from sysfs, and core/package/NUMA counts. All results live in one
+// struct that is filled once and cached; kernels pick their variant through
+// CPU_DISPATCH at startup so the hot path never re-checks features.
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+// x86-64 only: the kernels use 64-bit intrinsics (_mm_extract_epi64, _pdep_u64,
+// ...), so 32-bit x86 builds take the portable paths.
+#ifdef __x86_64__
+#include <cpuid.h>
+#define CPU_X86 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cumulative feature levels, modeled on the x86-64 psABI micro-architecture
+// levels: each one implies everything below it.
+enum cpu_level {
+    CPU_LEVEL_SCALAR = 0, // portable C only
+    CPU_LEVEL_SSE42,      // SSE4.2 + POPCNT
+    CPU_LEVEL_AVX2,       // AVX2 + FMA + BMI1/2 + LZCNT (x86-64-v3)
+    CPU_LEVEL_AVX512,     // AVX-512 F/BW/VL/DQ (x86-64-v4)
+    CPU_LEVEL_COUNT
+};
+
+// Attributes for kernels compiled for a higher level than the build baseline.
+#ifdef CPU_X86
+#define CPU_TARGET_SSE42  __attribute__((target("sse4.2,popcnt")))
+#define CPU_TARGET_AVX2   __attribute__((target("avx2,fma,bmi,bmi2,lzcnt,popcnt")))
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,avx2,fma,bmi,bmi2,lzcnt,popcnt")))
+#else
+#define CPU_TARGET_SSE42
+#define CPU_TARGET_AVX2
+#define CPU_TARGET_AVX512
+#endif
+
+struct cpu_cache {
+    size_t size;          // bytes, 0 if unknown
+    unsigned line;        // coherency line size in bytes
+    unsigned ways;        // associativity, 0 if unknown/fully associative
+    unsigned shared_cpus; // logical CPUs sharing this cache
+};
+
+struct cpu_info {
+    char vendor[13];
+    char brand[49];
+
+    // Individual features (already masked by OS support for AVX state)
+    bool sse2, sse42, popcnt, avx, avx2, fma, bmi1, bmi2, lzcnt;
+    bool avx512f, avx512bw, avx512vl, avx512dq, avx512vpopcntdq;
+
+    enum cpu_level level;    // highest usable level (after CPU_LEVEL env cap)
+
+    struct cpu_cache l1d, l1i, l2, l3;
+    unsigned line_size;      // L1d line size, 64 when unknown
+
+    unsigned logical_cpus;   // online logical CPUs
+    unsigned physical_cores; // distinct (package, core) pairs
+    unsigned packages;       // sockets
+    unsigned numa_nodes;     // online NUMA nodes
+};
+
+static inline const char *cpu_level_name(enum cpu_level lvl) {
+    switch (lvl) {
+        case CPU_LEVEL_SCALAR: return "scalar";
+        case CPU_LEVEL_SSE42:  return "sse4.2";
+        case CPU_LEVEL_AVX2:   return "avx2";
+        case CPU_LEVEL_AVX512: return "avx512";
+        default:               return "?";
+    }
+}
+
+// Read a small sysfs file into buf; returns false when missing.
+static inline bool cpu_read_sysfs(const char *path, char *buf, size_t size) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+    bool ok = fgets(buf, (int)size, f) != NULL;
+    fclose(f);
+    if (ok) {
+        size_t n = strlen(buf);
+        while (n && isspace((unsigned char)buf[n - 1])) buf[--n] = '\0';
+    }
+    return ok;
+}
+
+// Count CPUs in a kernel cpulist string such as "0-3,8-11".
+static inline unsigned cpu_count_list(const char *s) {
+    unsigned count = 0;
+    while (*s) {
+        char *end = NULL;
+        long lo = strtol(s, &end, 10);
+        if (end == s) break;
+        long hi = lo;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+            if (end == s) break;
+        }
+        if (hi >= lo) count += (unsigned)(hi - lo + 1);
+        s = (*end == ',') ? end + 1 : end;
+        if (*end != ',') break;
+    }
+    return count;
+}
+
+// Parse sizes such as "48K", "2048K", "32M".
+static inline size_t cpu_parse_size(const char *s) {
+    char *end = NULL;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (end == s) return 0;
+    if (*end == 'K' || *end == 'k') v <<= 10;
+    else if (*end == 'M' || *end == 'm') v <<= 20;
+    else if (*end == 'G' || *end == 'g') v <<= 30;
+    return (size_t)v;
+}
+
+static inline void cpu_probe_caches(struct cpu_info *ci) {
+    char path[128], buf[256];
+    for (int idx = 0; idx < 16; ++idx) {
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu0/cache/index%d/level", idx);
+        if (!cpu_read_sysfs(path, buf, sizeof buf)) break;
+        int level = atoi(buf);
+
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu0/cache/index%d/type", idx);
+        char type[32] = "";
+        cpu_read_sysfs(path, type, sizeof type);
+
+        struct cpu_cache c = {0, 0, 0, 0};
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu0/cache/index%d/size", idx);
+        if (cpu_read_sysfs(path, buf, sizeof buf)) c.size = cpu_parse_size(buf);
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", idx);
+        if (cpu_read_sysfs(path, buf, sizeof buf)) c.line = (unsigned)atoi(buf);
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu0/cache/index%d/ways_of_associativity", idx);
+        if (cpu_read_sysfs(path, buf, sizeof buf)) c.ways = (unsigned)atoi(buf);
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu0/cache/index%d/shared_cpu_list", idx);
+        if (cpu_read_sysfs(path, buf, sizeof buf)) c.shared_cpus = cpu_count_list(buf);
+
+        if (level == 1 && strcmp(type, "Instruction") == 0) ci->l1i = c;
+        else if (level == 1) ci->l1d = c;
+        else if (level == 2) ci->l2 = c;
+        else if (level == 3) ci->l3 = c;
+    }
+
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    // glibc fallback when sysfs is not mounted (containers, chroots)
+    if (!ci->l1d.size) {
+        long v = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+        if (v > 0) ci->l1d.size = (size_t)v;
+        v = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+        if (v > 0) ci->l1d.line = (unsigned)v;
+    }
+    if (!ci->l2.size) {
+        long v = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (v > 0) ci->l2.size = (size_t)v;
+    }
+    if (!ci->l3.size) {
+        long v = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (v > 0) ci->l3.size = (size_t)v;
+    }
+#endif
+    ci->line_size = ci->l1d.line ? ci->l1d.line : 64;
+}
+
+static inline void cpu_probe_topology(struct cpu_info *ci) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    ci->logical_cpus = online > 0 ? (unsigned)online : 1;
+
+    // Distinct (package, core) pairs; a small linear set is enough here.
+    enum { MAX_PAIRS = 4096 };
+    static long pairs[MAX_PAIRS][2];
+    static long pkgs[256];
+    unsigned npairs = 0, npkgs = 0;
+    char path[128], buf[64];
+    long conf = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu = 0; cpu < conf && cpu < MAX_PAIRS; ++cpu) {
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu%ld/topology/physical_package_id", cpu);
+        if (!cpu_read_sysfs(path, buf, sizeof buf)) continue;
+        long pkg = atol(buf);
+        snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu%ld/topology/core_id", cpu);
+        if (!cpu_read_sysfs(path, buf, sizeof buf)) continue;
+        long core = atol(buf);
+
+        bool seen = false;
+        for (unsigned i = 0; i < npairs && !seen; ++i)
+            seen = pairs[i][0] == pkg && pairs[i][1] == core;
+        if (!seen) { pairs[npairs][0] = pkg; pairs[npairs][1] = core; ++npairs; }
+
+        seen = false;
+        for (unsigned i = 0; i < npkgs && !seen; ++i) seen = pkgs[i] == pkg;
+        if (!seen && npkgs < 256) pkgs[npkgs++] = pkg;
+    }
+    ci->physical_cores = npairs ? npairs : ci->logical_cpus;
+    ci->packages = npkgs ? npkgs : 1;
+
+    ci->numa_nodes = 1;
+    if (cpu_read_sysfs("/sys/devices/system/node/online", buf, sizeof buf)) {
+        unsigned n = cpu_count_list(buf);
+        if (n) ci->numa_nodes = n;
+    }
+}
+
+static inline void cpu_probe_features(struct cpu_info *ci) {
+    strcpy(ci->vendor, "unknown");
+    strcpy(ci->brand, "unknown");
+#ifdef CPU_X86
+    unsigned a, b, c, d;
+    if (!__get_cpuid(0, &a, &b, &c, &d)) return;
+    unsigned max_leaf = a;
+    memcpy(ci->vendor + 0, &b, 4);
+    memcpy(ci->vendor + 4, &d, 4);
+    memcpy(ci->vendor + 8, &c, 4);
+    ci->vendor[12] = '\0';
+
+    unsigned ecx1 = 0, edx1 = 0, ebx7 = 0, ecx7 = 0;
+    if (__get_cpuid(1, &a, &b, &ecx1, &edx1)) {
+        ci->sse2 = edx1 & (1u << 26);
+        ci->sse42 = ecx1 & (1u << 20);
+        ci->popcnt = ecx1 & (1u << 23);
+    }
+    if (max_leaf >= 7) __cpuid_count(7, 0, a, ebx7, ecx7, d);
+
+    // AVX state must be enabled by the OS (OSXSAVE + XCR0), not just present.
+    bool ymm_ok = false, zmm_ok = false;
+    if (ecx1 & (1u << 27)) {
+        unsigned xlo, xhi;
+        __asm__ volatile("xgetbv" : "=a"(xlo), "=d"(xhi) : "c"(0));
+        ymm_ok = (xlo & 0x6) == 0x6;
+        zmm_ok = ymm_ok && (xlo & 0xE0) == 0xE0;
+    }
+    ci->avx = ymm_ok && (ecx1 & (1u << 28));
+    ci->fma = ymm_ok && (ecx1 & (1u << 12));
+    ci->avx2 = ci->avx && (ebx7 & (1u << 5));
+    ci->bmi1 = ebx7 & (1u << 3);
+    ci->bmi2 = ebx7 & (1u << 8);
+    ci->avx512f = zmm_ok && (ebx7 & (1u << 16));
+    ci->avx512dq = ci->avx512f && (ebx7 & (1u << 17));
+    ci->avx512bw = ci->avx512f && (ebx7 & (1u << 30));
+    ci->avx512vl = ci->avx512f && (ebx7 & (1u << 31));
+    ci->avx512vpopcntdq = ci->avx512f && (ecx7 & (1u << 14));
+
+    if (__get_cpuid(0x80000000, &a, &b, &c, &d)) {
+        unsigned max_ext = a;
+        if (max_ext >= 0x80000001 && __get_cpuid(0x80000001, &a, &b, &c, &d))
+            ci->lzcnt = c & (1u << 5);
+        if (max_ext >= 0x80000004) {
+            unsigned regs[12];
+            for (unsigned i = 0; i < 3; ++i)
+                __get_cpuid(0x80000002 + i, &regs[i*4], &regs[i*4+1], &regs[i*4+2], &regs[i*4+3]);
+            memcpy(ci->brand, regs, 48);
+            ci->brand[48] = '\0';
+            // Brand strings are often left-padded with spaces
+            char *p = ci->brand;
+            while (*p == ' ') ++p;
+            memmove(ci->brand, p, strlen(p) + 1);
+        }
+    }
+#endif
+}
+
+static inline enum cpu_level cpu_compute_level(const struct cpu_info *ci) {
+    enum cpu_level lvl = CPU_LEVEL_SCALAR;
+    if (ci->sse42 && ci->popcnt) lvl = CPU_LEVEL_SSE42;
+    if (lvl == CPU_LEVEL_SSE42 && ci->avx2 && ci->fma && ci->bmi1 && ci->bmi2 && ci->lzcnt)
+        lvl = CPU_LEVEL_AVX2;
+    if (lvl == CPU_LEVEL_AVX2 && ci->avx512f && ci->avx512bw && ci->avx512vl && ci->avx512dq)
+        lvl = CPU_LEVEL_AVX512;
+
+    // CPU_LEVEL=scalar|sse4.2|avx2|avx512 caps the level (benchmarks, debugging)
+    const char *cap = getenv("CPU_LEVEL");
+    if (cap) {
+        for (int i = 0; i < CPU_LEVEL_COUNT; ++i) {
+            if (strcmp(cap, cpu_level_name((enum cpu_level)i)) == 0 && i < (int)lvl) {
+                lvl = (enum cpu_level)i;
+                break;
+            }
+        }
+    }
+    return lvl;
+}
+
+// Probe once and return the cached result. Safe to call from several threads:
+// the first caller probes, the others wait until the struct is published.
+static inline const struct cpu_info *cpu_info(void) {
+    static struct cpu_info info;
+    static int state; // 0 = unprobed, 1 = probing, 2 = ready
+    if (__atomic_load_n(&state, __ATOMIC_ACQUIRE) == 2) return &info;
+
+    int expected = 0;
+    if (__atomic_compare_exchange_n(&state, &expected, 1, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        memset(&info, 0, sizeof info);
+        cpu_probe_features(&info);
+        cpu_probe_caches(&info);
+        cpu_probe_topology(&info);
+        info.level = cpu_compute_level(&info);
+        __atomic_store_n(&state, 2, __ATOMIC_RELEASE);
+    } else {
+        while (__atomic_load_n(&state, __ATOMIC_ACQUIRE) != 2) {}
+    }
+    return &info;
+}
+
+// Store into dst the best entry of a per-level table (indexed by enum
+// cpu_level) that the running CPU supports. NULL entries are skipped, so a
+// table only needs the variants it actually has. Call once at startup.
+#define CPU_DISPATCH(dst, table) do {                                        \
+        int lvl_ = (int)cpu_info()->level;                                   \
+        int max_ = (int)(sizeof(table) / sizeof((table)[0])) - 1;            \
+        if (lvl_ > max_) lvl_ = max_;                                        \
+        while (lvl_ > 0 && !(table)[lvl_]) --lvl_;                           \
+        (dst) = (table)[lvl_];                                               \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CPUPROBE_H
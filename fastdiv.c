@@ -0,0 +1,229 @@
+// Build: gcc -O2 fastdiv.c -o build/fastdiv
+// Usage: build/fastdiv [divisor]   (default 7; taken from argv so it is not a constant)
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fastdiv.h"
+
+#define LEN(x) (sizeof(x)/sizeof((x)[0]))
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+static uint64_t rng(void) {
+    uint64_t x = rng_state;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return rng_state = x;
+}
+
+// ---- Demos ----
+
+// divide_checked from stdlibc.c asserts on every call; here the divisor is
+// checked once, when the divider is built.
+static void checked_demo(void) {
+    struct fdiv_s32 f;
+    if (!fdiv_s32_init(&f, 0)) puts("fdiv_s32_init(0): rejected, no divider built");
+    fdiv_s32_init(&f, 2);
+    printf("divide_checked(8,2) = %d\n", fdiv_s32_q(&f, 8));
+
+    // The a/b and a%b of operators_demo, including negative operands
+    int a[] = {7, -7, 7, -7}, b[] = {3, 3, -3, -3};
+    for (size_t i = 0; i < LEN(a); ++i) {
+        fdiv_s32_init(&f, b[i]);
+        printf("%2d / %2d = %2d (C: %2d), %2d %% %2d = %2d (C: %2d)\n", a[i], b[i], fdiv_s32_q(&f, a[i]),
+               a[i] / b[i], a[i], b[i], fdiv_s32_r(&f, a[i]), a[i] % b[i]);
+    }
+
+    static const char *kinds[] = {"shift", "mul", "mul+add"};
+    uint32_t ds[] = {1, 3, 7, 8, 10, 641, 0x80000000u, 0xffffffffu};
+    for (size_t i = 0; i < LEN(ds); ++i) {
+        struct fdiv_u32 u;
+        fdiv_u32_init(&u, ds[i]);
+        printf("  u32 d=%-10u %-7s magic=0x%08x shift=%u\n", ds[i], kinds[u.kind], u.magic, u.shift);
+    }
+}
+
+// ---- Verification against the hardware divider ----
+
+static uint64_t edge_u64[] = {0, 1, 2, 3, 7, 0x7fffffffull, 0x80000000ull, 0xffffffffull, 0x100000000ull,
+                              INT64_MAX, (uint64_t)INT64_MAX + 1, UINT64_MAX, UINT64_MAX - 1};
+
+static long verify_divisor_u32(uint32_t d) {
+    struct fdiv_u32 f;
+    fdiv_u32_init(&f, d);
+    long bad = 0;
+    uint32_t in[64], q[64], r[64];
+    for (size_t i = 0; i < LEN(in); ++i) in[i] = i < LEN(edge_u64) ? (uint32_t)edge_u64[i] : (uint32_t)rng();
+    fdiv_u32_bulk(&f, in, q, r, LEN(in));
+    for (size_t i = 0; i < LEN(in); ++i)
+        bad += q[i] != in[i] / d || r[i] != in[i] % d || fdiv_u32_q(&f, in[i]) != in[i] / d;
+    return bad;
+}
+
+static long verify_divisor_s32(int32_t d) {
+    struct fdiv_s32 f;
+    fdiv_s32_init(&f, d);
+    long bad = 0;
+    int32_t in[64], q[64], r[64];
+    for (size_t i = 0; i < LEN(in); ++i) {
+        in[i] = i < LEN(edge_u64) ? (int32_t)(uint32_t)edge_u64[i] : (int32_t)rng();
+        if (i & 1) in[i] = (int32_t)(0u - (uint32_t)in[i]);
+    }
+    fdiv_s32_bulk(&f, in, q, r, LEN(in));
+    for (size_t i = 0; i < LEN(in); ++i) {
+        if (d == -1 && in[i] == INT32_MIN) { bad += q[i] != INT32_MIN || r[i] != 0; continue; }
+        bad += q[i] != in[i] / d || r[i] != in[i] % d || fdiv_s32_q(&f, in[i]) != in[i] / d;
+    }
+    return bad;
+}
+
+static long verify_divisor_u64(uint64_t d) {
+    struct fdiv_u64 f;
+    fdiv_u64_init(&f, d);
+    long bad = 0;
+    for (size_t i = 0; i < 64; ++i) {
+        uint64_t x = i < LEN(edge_u64) ? edge_u64[i] : rng() >> (rng() & 63);
+        bad += fdiv_u64_q(&f, x) != x / d || fdiv_u64_r(&f, x) != x % d;
+    }
+    return bad;
+}
+
+static long verify_divisor_s64(int64_t d) {
+    struct fdiv_s64 f;
+    fdiv_s64_init(&f, d);
+    long bad = 0;
+    for (size_t i = 0; i < 64; ++i) {
+        int64_t x = (int64_t)(i < LEN(edge_u64) ? edge_u64[i] : rng() >> (rng() & 63));
+        if (i & 1) x = (int64_t)(0ull - (uint64_t)x);
+        if (d == -1 && x == INT64_MIN) { bad += fdiv_s64_q(&f, x) != INT64_MIN || fdiv_s64_r(&f, x) != 0; continue; }
+        bad += fdiv_s64_q(&f, x) != x / d || fdiv_s64_r(&f, x) != x % d;
+    }
+    return bad;
+}
+
+static void verify(void) {
+    long bad = 0, divisors = 0;
+    for (uint64_t d = 1; d <= 2000; ++d, ++divisors) {
+        bad += verify_divisor_u32((uint32_t)d) + verify_divisor_u64(d);
+        bad += verify_divisor_s32((int32_t)d) + verify_divisor_s32(-(int32_t)d);
+        bad += verify_divisor_s64((int64_t)d) + verify_divisor_s64(-(int64_t)d);
+    }
+    for (int k = 0; k < 64; ++k, ++divisors) { // powers of two and their neighbours
+        for (int delta = -1; delta <= 1; ++delta) {
+            uint64_t d = (1ull << k) + (uint64_t)delta;
+            if (!d) continue;
+            if (d <= UINT32_MAX) bad += verify_divisor_u32((uint32_t)d);
+            if (d <= INT32_MAX) bad += verify_divisor_s32((int32_t)d) + verify_divisor_s32(-(int32_t)d);
+            bad += verify_divisor_u64(d);
+            if (d <= INT64_MAX) bad += verify_divisor_s64((int64_t)d) + verify_divisor_s64(-(int64_t)d);
+        }
+    }
+    bad += verify_divisor_s32(INT32_MIN) + verify_divisor_s64(INT64_MIN);
+    bad += verify_divisor_u32(UINT32_MAX) + verify_divisor_u64(UINT64_MAX);
+    for (int i = 0; i < 100000; ++i, ++divisors) {
+        uint64_t d = rng() >> (rng() & 63);
+        if (!d) continue;
+        bad += verify_divisor_u32((uint32_t)d ? (uint32_t)d : 1) + verify_divisor_u64(d);
+        bad += verify_divisor_s32((int32_t)d ? (int32_t)d : 1) + verify_divisor_s64((int64_t)d ? (int64_t)d : 1);
+    }
+    printf("checked %ld divisors x 64 numerators per type: %s\n", divisors, bad ? "MISMATCH" : "ok");
+}
+
+// ---- Benchmark ----
+
+static void bench(int64_t dv) {
+    const size_t n = (size_t)1 << 24;
+    const int reps = 5;
+    uint32_t *u = malloc(n * sizeof *u), *q = malloc(n * sizeof *q), *r = malloc(n * sizeof *r);
+    uint64_t *u64 = malloc(n * sizeof *u64), *q64 = malloc(n * sizeof *q64);
+    if (!u || !q || !r || !u64 || !q64) { perror("malloc"); goto out; }
+    for (size_t i = 0; i < n; ++i) { u[i] = (uint32_t)rng(); u64[i] = rng(); }
+
+    struct fdiv_u32 fu;
+    struct fdiv_s32 fs;
+    struct fdiv_u64 fu64;
+    if (!fdiv_u32_init(&fu, (uint32_t)dv) || !fdiv_s32_init(&fs, (int32_t)dv) || !fdiv_u64_init(&fu64, (uint64_t)dv)) {
+        puts("divisor 0 rejected");
+        goto out;
+    }
+    uint32_t d32 = (uint32_t)dv;
+    int32_t s32 = (int32_t)dv;
+    uint64_t d64 = (uint64_t)dv;
+    double mvals = (double)n * reps / 1e6;
+    uint64_t check = 0, ref = 0;
+
+    printf("divide %zu values by %lld (%d reps), Mvalues/s:\n", n, (long long)dv, reps);
+    double t0 = now_sec();
+    for (int k = 0; k < reps; ++k) for (size_t i = 0; i < n; ++i) { q[i] = u[i] / d32; r[i] = u[i] % d32; }
+    double t = now_sec() - t0;
+    for (size_t i = 0; i < n; ++i) ref += q[i] ^ r[i];
+    printf("  u32 q+r  hardware div %8.0f\n", mvals / t);
+
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) fdiv_u32_bulk_scalar(&fu, u, q, r, n);
+    t = now_sec() - t0;
+    check = 0;
+    for (size_t i = 0; i < n; ++i) check += q[i] ^ r[i];
+    printf("  u32 q+r  fdiv scalar  %8.0f %s\n", mvals / t, check == ref ? "ok" : "MISMATCH");
+
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) fdiv_u32_bulk(&fu, u, q, r, n);
+    t = now_sec() - t0;
+    check = 0;
+    for (size_t i = 0; i < n; ++i) check += q[i] ^ r[i];
+    printf("  u32 q+r  fdiv bulk    %8.0f %s (%s)\n", mvals / t, check == ref ? "ok" : "MISMATCH",
+           cpu_level_name(cpu_info()->level >= CPU_LEVEL_AVX2 ? CPU_LEVEL_AVX2 : CPU_LEVEL_SCALAR));
+
+    int32_t *s = (int32_t *)u, *sq = (int32_t *)q;
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) for (size_t i = 0; i < n; ++i) sq[i] = s[i] / s32;
+    t = now_sec() - t0;
+    ref = 0;
+    for (size_t i = 0; i < n; ++i) ref += (uint32_t)sq[i];
+    printf("  s32 q    hardware div %8.0f\n", mvals / t);
+
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) fdiv_s32_bulk(&fs, s, sq, NULL, n);
+    t = now_sec() - t0;
+    check = 0;
+    for (size_t i = 0; i < n; ++i) check += (uint32_t)sq[i];
+    printf("  s32 q    fdiv bulk    %8.0f %s\n", mvals / t, check == ref ? "ok" : "MISMATCH");
+
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) for (size_t i = 0; i < n; ++i) q64[i] = u64[i] / d64;
+    t = now_sec() - t0;
+    ref = 0;
+    for (size_t i = 0; i < n; ++i) ref += q64[i];
+    printf("  u64 q    hardware div %8.0f\n", mvals / t);
+
+    t0 = now_sec();
+    for (int k = 0; k < reps; ++k) fdiv_u64_bulk(&fu64, u64, q64, NULL, n);
+    t = now_sec() - t0;
+    check = 0;
+    for (size_t i = 0; i < n; ++i) check += q64[i];
+    printf("  u64 q    fdiv scalar  %8.0f %s\n", mvals / t, check == ref ? "ok" : "MISMATCH");
+out:
+    free(u); free(q); free(r); free(u64); free(q64);
+}
+
+int main(int argc, char **argv) {
+    int64_t d = argc > 1 ? strtoll(argv[1], NULL, 10) : 7;
+    fdiv_kernels_init();
+
+    puts("-- Fast Division: checked once --");
+    checked_demo();
+
+    puts("\n-- Fast Division: verification --");
+    verify();
+
+    puts("\n-- Fast Division: benchmark --");
+    bench(d);
+    return 0;
+}
@@ -0,0 +1,325 @@
+#ifndef FASTDIV_H
+#define FASTDIV_H
+
+// Division by a divisor that is fixed at runtime but used many times.
+//
+// fdiv_*_init() checks the divisor once (false for zero) and precomputes a
+// magic multiplier and shift (Granlund-Montgomery; the same scheme compilers
+// use for constant divisors), so every later quotient is a multiply-high plus
+// shifts instead of a 20-90 cycle hardware divide. Powers of two reduce to a
+// shift. Results match C's / and % (truncation toward zero) for every input,
+// except that INT_MIN / -1 wraps to INT_MIN (remainder 0) instead of trapping.
+//
+// The *_bulk() functions divide whole arrays; the 32-bit ones use AVX2 when
+// the CPU has it (8 lanes per instruction) once fdiv_kernels_init() has run.
+// The 64-bit ones stay scalar: AVX2 and AVX-512 have no 64x64->128
+// multiply-high, so emulating it costs more than the scalar mulq it replaces.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "cpuprobe.h"
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+enum fdiv_kind {
+    FDIV_SHIFT,    // |d| is a power of two
+    FDIV_MUL,      // magic fits the word: mulhi + shift
+    FDIV_MUL_ADD,  // magic needs one more bit: mulhi + add + shift
+};
+
+struct fdiv_u32 { uint32_t d, magic; uint8_t shift, kind; };
+struct fdiv_s32 { int32_t d, magic; uint8_t shift, kind; bool neg; };
+struct fdiv_u64 { uint64_t d, magic; uint8_t shift, kind; };
+struct fdiv_s64 { int64_t d, magic; uint8_t shift, kind; bool neg; };
+
+// ---- Construction ----
+
+static inline bool fdiv_u32_init(struct fdiv_u32 *f, uint32_t d) {
+    memset(f, 0, sizeof *f);
+    if (!d) return false;
+    f->d = d;
+    unsigned lg = 31u - (unsigned)__builtin_clz(d);
+    f->shift = (uint8_t)lg;
+    if ((d & (d - 1)) == 0) { f->kind = FDIV_SHIFT; return true; }
+    uint64_t num = 1ull << (32 + lg);
+    uint32_t m = (uint32_t)(num / d), rem = (uint32_t)(num % d);
+    if (d - rem < (1u << lg)) {
+        f->kind = FDIV_MUL;
+    } else {
+        // 33-bit magic: keep the low 32 bits, the top bit becomes the add
+        m += m;
+        uint32_t rem2 = rem + rem;
+        if (rem2 >= d || rem2 < rem) m += 1;
+        f->kind = FDIV_MUL_ADD;
+    }
+    f->magic = m + 1;
+    return true;
+}
+
+static inline bool fdiv_u64_init(struct fdiv_u64 *f, uint64_t d) {
+    memset(f, 0, sizeof *f);
+    if (!d) return false;
+    f->d = d;
+    unsigned lg = 63u - (unsigned)__builtin_clzll(d);
+    f->shift = (uint8_t)lg;
+    if ((d & (d - 1)) == 0) { f->kind = FDIV_SHIFT; return true; }
+    unsigned __int128 num = (unsigned __int128)1 << (64 + lg);
+    uint64_t m = (uint64_t)(num / d), rem = (uint64_t)(num % d);
+    if (d - rem < (1ull << lg)) {
+        f->kind = FDIV_MUL;
+    } else {
+        m += m;
+        uint64_t rem2 = rem + rem;
+        if (rem2 >= d || rem2 < rem) m += 1;
+        f->kind = FDIV_MUL_ADD;
+    }
+    f->magic = m + 1;
+    return true;
+}
+
+static inline bool fdiv_s32_init(struct fdiv_s32 *f, int32_t d) {
+    memset(f, 0, sizeof *f);
+    if (!d) return false;
+    f->d = d;
+    f->neg = d < 0;
+    uint32_t ad = f->neg ? 0u - (uint32_t)d : (uint32_t)d;
+    unsigned lg = 31u - (unsigned)__builtin_clz(ad);
+    if ((ad & (ad - 1)) == 0) { f->kind = FDIV_SHIFT; f->shift = (uint8_t)lg; return true; }
+    uint64_t num = 1ull << (32 + lg - 1);
+    uint32_t m = (uint32_t)(num / ad), rem = (uint32_t)(num % ad);
+    if (ad - rem < (1u << lg)) {
+        f->kind = FDIV_MUL;
+        f->shift = (uint8_t)(lg - 1);
+    } else {
+        m += m;
+        uint32_t rem2 = rem + rem;
+        if (rem2 >= ad || rem2 < rem) m += 1;
+        f->kind = FDIV_MUL_ADD;
+        f->shift = (uint8_t)lg;
+    }
+    m += 1;
+    f->magic = (int32_t)(f->neg ? 0u - m : m);
+    return true;
+}
+
+static inline bool fdiv_s64_init(struct fdiv_s64 *f, int64_t d) {
+    memset(f, 0, sizeof *f);
+    if (!d) return false;
+    f->d = d;
+    f->neg = d < 0;
+    uint64_t ad = f->neg ? 0ull - (uint64_t)d : (uint64_t)d;
+    unsigned lg = 63u - (unsigned)__builtin_clzll(ad);
+    if ((ad & (ad - 1)) == 0) { f->kind = FDIV_SHIFT; f->shift = (uint8_t)lg; return true; }
+    unsigned __int128 num = (unsigned __int128)1 << (64 + lg - 1);
+    uint64_t m = (uint64_t)(num / ad), rem = (uint64_t)(num % ad);
+    if (ad - rem < (1ull << lg)) {
+        f->kind = FDIV_MUL;
+        f->shift = (uint8_t)(lg - 1);
+    } else {
+        m += m;
+        uint64_t rem2 = rem + rem;
+        if (rem2 >= ad || rem2 < rem) m += 1;
+        f->kind = FDIV_MUL_ADD;
+        f->shift = (uint8_t)lg;
+    }
+    m += 1;
+    f->magic = (int64_t)(f->neg ? 0ull - m : m);
+    return true;
+}
+
+// ---- Single values ----
+
+static inline uint32_t fdiv_u32_q(const struct fdiv_u32 *f, uint32_t n) {
+    if (f->kind == FDIV_SHIFT) return n >> f->shift;
+    uint32_t t = (uint32_t)(((uint64_t)f->magic * n) >> 32);
+    if (f->kind == FDIV_MUL) return t >> f->shift;
+    return (((n - t) >> 1) + t) >> f->shift;
+}
+
+static inline uint64_t fdiv_u64_q(const struct fdiv_u64 *f, uint64_t n) {
+    if (f->kind == FDIV_SHIFT) return n >> f->shift;
+    uint64_t t = (uint64_t)(((unsigned __int128)f->magic * n) >> 64);
+    if (f->kind == FDIV_MUL) return t >> f->shift;
+    return (((n - t) >> 1) + t) >> f->shift;
+}
+
+// Signed: compute on the magnitude's magic, then fix the rounding so the
+// quotient truncates toward zero. Arithmetic is done unsigned where it may wrap.
+static inline int32_t fdiv_s32_q(const struct fdiv_s32 *f, int32_t n) {
+    uint32_t sign = f->neg ? ~0u : 0u;
+    if (f->kind == FDIV_SHIFT) {
+        uint32_t mask = (1u << f->shift) - 1;
+        uint32_t q = (uint32_t)n + ((uint32_t)(n >> 31) & mask); // bias negatives up
+        q = (uint32_t)((int32_t)q >> f->shift);
+        return (int32_t)((q ^ sign) - sign);
+    }
+    uint32_t uq = (uint32_t)(((int64_t)f->magic * n) >> 32);
+    if (f->kind == FDIV_MUL_ADD) uq += ((uint32_t)n ^ sign) - sign;
+    int32_t q = (int32_t)uq >> f->shift;
+    return q + (int32_t)((uint32_t)q >> 31);
+}
+
+static inline int64_t fdiv_s64_q(const struct fdiv_s64 *f, int64_t n) {
+    uint64_t sign = f->neg ? ~0ull : 0ull;
+    if (f->kind == FDIV_SHIFT) {
+        uint64_t mask = (1ull << f->shift) - 1;
+        uint64_t q = (uint64_t)n + ((uint64_t)(n >> 63) & mask);
+        q = (uint64_t)((int64_t)q >> f->shift);
+        return (int64_t)((q ^ sign) - sign);
+    }
+    uint64_t uq = (uint64_t)(((__int128)f->magic * n) >> 64);
+    if (f->kind == FDIV_MUL_ADD) uq += ((uint64_t)n ^ sign) - sign;
+    int64_t q = (int64_t)uq >> f->shift;
+    return q + (int64_t)((uint64_t)q >> 63);
+}
+
+static inline uint32_t fdiv_u32_r(const struct fdiv_u32 *f, uint32_t n) { return n - fdiv_u32_q(f, n) * f->d; }
+static inline uint64_t fdiv_u64_r(const struct fdiv_u64 *f, uint64_t n) { return n - fdiv_u64_q(f, n) * f->d; }
+static inline int32_t fdiv_s32_r(const struct fdiv_s32 *f, int32_t n) {
+    return (int32_t)((uint32_t)n - (uint32_t)fdiv_s32_q(f, n) * (uint32_t)f->d);
+}
+static inline int64_t fdiv_s64_r(const struct fdiv_s64 *f, int64_t n) {
+    return (int64_t)((uint64_t)n - (uint64_t)fdiv_s64_q(f, n) * (uint64_t)f->d);
+}
+
+// ---- Arrays ----
+// q[i] = in[i] / d and r[i] = in[i] % d; q or r may be NULL. The outputs may
+// alias in.
+
+static inline void fdiv_u32_bulk_scalar(const struct fdiv_u32 *f, const uint32_t *in, uint32_t *q, uint32_t *r, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t x = in[i], y = fdiv_u32_q(f, x);
+        if (q) q[i] = y;
+        if (r) r[i] = x - y * f->d;
+    }
+}
+
+static inline void fdiv_s32_bulk_scalar(const struct fdiv_s32 *f, const int32_t *in, int32_t *q, int32_t *r, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        int32_t x = in[i], y = fdiv_s32_q(f, x);
+        if (q) q[i] = y;
+        if (r) r[i] = (int32_t)((uint32_t)x - (uint32_t)y * (uint32_t)f->d);
+    }
+}
+
+#ifdef CPU_X86
+// High 32 bits of 8 lane products: even lanes from one widening multiply,
+// odd lanes from a second one on the shifted input.
+CPU_TARGET_AVX2
+static inline __m256i fdiv_mulhi_epu32(__m256i a, __m256i m) {
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, m), 32);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    return _mm256_blend_epi32(even, odd, 0xaa);
+}
+
+CPU_TARGET_AVX2
+static inline __m256i fdiv_mulhi_epi32(__m256i a, __m256i m) {
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epi32(a, m), 32);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), m);
+    return _mm256_blend_epi32(even, odd, 0xaa);
+}
+
+CPU_TARGET_AVX2
+static inline void fdiv_u32_bulk_avx2(const struct fdiv_u32 *f, const uint32_t *in, uint32_t *q, uint32_t *r, size_t n) {
+    const __m256i m = _mm256_set1_epi32((int)f->magic), d = _mm256_set1_epi32((int)f->d);
+    const __m128i sh = _mm_cvtsi32_si128(f->shift);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(in + i)), y;
+        if (f->kind == FDIV_SHIFT) {
+            y = _mm256_srl_epi32(x, sh);
+        } else {
+            __m256i t = fdiv_mulhi_epu32(x, m);
+            if (f->kind == FDIV_MUL_ADD) t = _mm256_add_epi32(_mm256_srli_epi32(_mm256_sub_epi32(x, t), 1), t);
+            y = _mm256_srl_epi32(t, sh);
+        }
+        if (r) _mm256_storeu_si256((__m256i *)(r + i), _mm256_sub_epi32(x, _mm256_mullo_epi32(y, d)));
+        if (q) _mm256_storeu_si256((__m256i *)(q + i), y);
+    }
+    fdiv_u32_bulk_scalar(f, in + i, q ? q + i : NULL, r ? r + i : NULL, n - i);
+}
+
+CPU_TARGET_AVX2
+static inline void fdiv_s32_bulk_avx2(const struct fdiv_s32 *f, const int32_t *in, int32_t *q, int32_t *r, size_t n) {
+    const __m256i m = _mm256_set1_epi32(f->magic), d = _mm256_set1_epi32(f->d);
+    const __m256i sign = _mm256_set1_epi32(f->neg ? -1 : 0);
+    const __m256i mask = _mm256_set1_epi32((int)((1u << f->shift) - 1));
+    const __m128i sh = _mm_cvtsi32_si128(f->shift);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(in + i)), y;
+        if (f->kind == FDIV_SHIFT) {
+            y = _mm256_add_epi32(x, _mm256_and_si256(_mm256_srai_epi32(x, 31), mask));
+            y = _mm256_sra_epi32(y, sh);
+            y = _mm256_sub_epi32(_mm256_xor_si256(y, sign), sign);
+        } else {
+            y = fdiv_mulhi_epi32(x, m);
+            if (f->kind == FDIV_MUL_ADD) y = _mm256_add_epi32(y, _mm256_sub_epi32(_mm256_xor_si256(x, sign), sign));
+            y = _mm256_sra_epi32(y, sh);
+            y = _mm256_add_epi32(y, _mm256_srli_epi32(y, 31));
+        }
+        if (r) _mm256_storeu_si256((__m256i *)(r + i), _mm256_sub_epi32(x, _mm256_mullo_epi32(y, d)));
+        if (q) _mm256_storeu_si256((__m256i *)(q + i), y);
+    }
+    fdiv_s32_bulk_scalar(f, in + i, q ? q + i : NULL, r ? r + i : NULL, n - i);
+}
+#endif
+
+// Positional rather than designated initializers so the header also builds as C++.
+typedef void (*fdiv_u32_bulk_fn)(const struct fdiv_u32 *, const uint32_t *, uint32_t *, uint32_t *, size_t);
+typedef void (*fdiv_s32_bulk_fn)(const struct fdiv_s32 *, const int32_t *, int32_t *, int32_t *, size_t);
+
+static const fdiv_u32_bulk_fn fdiv_u32_bulk_table[CPU_LEVEL_COUNT] = {
+    fdiv_u32_bulk_scalar,    // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                    // CPU_LEVEL_SSE42
+    fdiv_u32_bulk_avx2,      // CPU_LEVEL_AVX2
+#endif
+};
+
+static const fdiv_s32_bulk_fn fdiv_s32_bulk_table[CPU_LEVEL_COUNT] = {
+    fdiv_s32_bulk_scalar,    // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                    // CPU_LEVEL_SSE42
+    fdiv_s32_bulk_avx2,      // CPU_LEVEL_AVX2
+#endif
+};
+
+// Bulk kernels in use; scalar until fdiv_kernels_init() runs. Call it once
+// at startup, before any threads, like the other *_kernels_init().
+static fdiv_u32_bulk_fn fdiv_u32_bulk_impl = fdiv_u32_bulk_scalar;
+static fdiv_s32_bulk_fn fdiv_s32_bulk_impl = fdiv_s32_bulk_scalar;
+
+static inline void fdiv_kernels_init(void) {
+    CPU_DISPATCH(fdiv_u32_bulk_impl, fdiv_u32_bulk_table);
+    CPU_DISPATCH(fdiv_s32_bulk_impl, fdiv_s32_bulk_table);
+}
+
+static inline void fdiv_u32_bulk(const struct fdiv_u32 *f, const uint32_t *in, uint32_t *q, uint32_t *r, size_t n) {
+    fdiv_u32_bulk_impl(f, in, q, r, n);
+}
+
+static inline void fdiv_s32_bulk(const struct fdiv_s32 *f, const int32_t *in, int32_t *q, int32_t *r, size_t n) {
+    fdiv_s32_bulk_impl(f, in, q, r, n);
+}
+
+static inline void fdiv_u64_bulk(const struct fdiv_u64 *f, const uint64_t *in, uint64_t *q, uint64_t *r, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t x = in[i], y = fdiv_u64_q(f, x);
+        if (q) q[i] = y;
+        if (r) r[i] = x - y * f->d;
+    }
+}
+
+static inline void fdiv_s64_bulk(const struct fdiv_s64 *f, const int64_t *in, int64_t *q, int64_t *r, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        int64_t x = in[i], y = fdiv_s64_q(f, x);
+        if (q) q[i] = y;
+        if (r) r[i] = (int64_t)((uint64_t)x - (uint64_t)y * (uint64_t)f->d);
+    }
+}
+
+#endif // FASTDIV_H
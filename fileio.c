@@ -0,0 +1,650 @@
+// Build: gcc -O2 fileio.c -o build/fileio
+// Usage: build/fileio [file]   (without a file, a temporary one is created)
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+// File-ingest layer. A reader hands out the file as a sequence of chunks in
+// file order; each chunk points straight into the reader's I/O buffer or the
+// mapping and stays valid until the next call. Three back ends:
+//   INGEST_URING  io_uring, queue_depth reads in flight, registered buffers
+//   INGEST_PREAD  pread (read for pipes) with sequential/readahead hints
+//   INGEST_MMAP   mmap + MADV_SEQUENTIAL, pages dropped behind the reader
+// INGEST_AUTO tries io_uring and falls back to pread.
+
+enum ingest_mode { INGEST_AUTO, INGEST_URING, INGEST_PREAD, INGEST_MMAP };
+
+struct ingest_opts {
+    enum ingest_mode mode;
+    size_t chunk_size;     // 0 = 256 KiB
+    unsigned queue_depth;  // 0 = 8 (io_uring in-flight reads, pread readahead window)
+};
+
+// Failure details, kept the way error_handling_demo reports them.
+struct ingest_error {
+    const char *op;        // failing call, e.g. "open", "io_uring_setup"
+    int err;               // errno value
+    char path[256];
+};
+
+struct ingest_chunk {
+    const void *data;
+    size_t len;
+    uint64_t offset;
+};
+
+static const char *ingest_mode_name(enum ingest_mode m) {
+    switch (m) {
+        case INGEST_URING: return "io_uring";
+        case INGEST_PREAD: return "pread";
+        case INGEST_MMAP:  return "mmap";
+        default:           return "auto";
+    }
+}
+
+static void ingest_set_error(struct ingest_error *e, const char *op, int err, const char *path) {
+    if (!e) return;
+    e->op = op;
+    e->err = err;
+    snprintf(e->path, sizeof e->path, "%s", path ? path : "");
+}
+
+static void ingest_perror(const struct ingest_error *e) {
+    fprintf(stderr, "%s failed on '%s': %s (errno=%d)\n", e->op, e->path, strerror(e->err), e->err);
+}
+
+// ---- Minimal io_uring over raw syscalls (no liburing dependency) ----
+#ifdef __linux__
+
+struct uring {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_size, cq_size, sqes_size;
+    unsigned to_submit;
+};
+
+static int uring_init(struct uring *u, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof p);
+    memset(u, 0, sizeof *u);
+    u->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (u->fd < 0) return -errno;
+
+    u->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single && u->cq_size > u->sq_size) u->sq_size = u->cq_size;
+
+    u->sq_ptr = mmap(NULL, u->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     u->fd, IORING_OFF_SQ_RING);
+    if (u->sq_ptr == MAP_FAILED) goto fail;
+    u->cq_ptr = single ? u->sq_ptr
+                       : mmap(NULL, u->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              u->fd, IORING_OFF_CQ_RING);
+    if (u->cq_ptr == MAP_FAILED) goto fail;
+    u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   u->fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) goto fail;
+
+    char *sq = u->sq_ptr, *cq = u->cq_ptr;
+    u->sq_head = (unsigned *)(sq + p.sq_off.head);
+    u->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    u->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)(sq + p.sq_off.array);
+    u->cq_head = (unsigned *)(cq + p.cq_off.head);
+    u->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    u->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    u->entries = p.sq_entries;
+    return 0;
+
+fail:;
+    int err = errno;
+    if (u->sq_ptr && u->sq_ptr != MAP_FAILED) munmap(u->sq_ptr, u->sq_size);
+    if (u->cq_ptr && u->cq_ptr != MAP_FAILED && !single) munmap(u->cq_ptr, u->cq_size);
+    close(u->fd);
+    u->fd = -1;
+    return -err;
+}
+
+static void uring_exit(struct uring *u) {
+    if (u->fd < 0) return;
+    munmap(u->sqes, u->sqes_size);
+    if (u->cq_ptr != u->sq_ptr) munmap(u->cq_ptr, u->cq_size);
+    munmap(u->sq_ptr, u->sq_size);
+    close(u->fd);
+    u->fd = -1;
+}
+
+// Next free submission slot, or NULL if the SQ is full. Only queues it;
+// uring_enter() submits everything queued in one syscall.
+static struct io_uring_sqe *uring_get_sqe(struct uring *u) {
+    unsigned tail = *u->sq_tail;
+    unsigned head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= u->entries) return NULL;
+    unsigned idx = tail & *u->sq_mask;
+    u->sq_array[idx] = idx;
+    struct io_uring_sqe *sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof *sqe);
+    __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    u->to_submit++;
+    return sqe;
+}
+
+static int uring_enter(struct uring *u, unsigned min_complete) {
+    for (;;) {
+        long r = syscall(__NR_io_uring_enter, u->fd, u->to_submit, min_complete,
+                         min_complete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (r >= 0) { u->to_submit -= (unsigned)r; return 0; }
+        if (errno != EINTR) return -errno;
+    }
+}
+
+#endif // __linux__
+
+// ---- Reader ----
+
+enum slot_state { SLOT_IDLE, SLOT_INFLIGHT, SLOT_READY, SLOT_HELD };
+
+struct ingest_slot {
+    uint64_t off;
+    size_t want, got;
+    enum slot_state state;
+};
+
+struct ingest_reader {
+    enum ingest_mode mode;       // back end actually in use
+    int fd;
+    bool stream;                 // not a regular file: sequential read()
+    uint64_t size;               // file size (regular files)
+    uint64_t next_off;           // next offset to request
+    uint64_t deliver_off;        // next offset to hand out
+    size_t chunk;
+    unsigned qd;
+    char path[256];
+
+    char *buf;                   // pread buffer or qd * chunk io_uring buffers
+
+    unsigned char *map;          // mmap mode
+    size_t map_len;
+    uint64_t dropped;            // pages before this were MADV_DONTNEED'd
+
+#ifdef __linux__
+    struct uring ring;
+    bool fixed;                  // buffers registered (READ_FIXED)
+    bool closing;                // draining: completed reads are not resubmitted
+    unsigned inflight;           // reads queued or in the kernel, not yet reaped
+#endif
+    struct ingest_slot *slots;
+    unsigned head;               // slot holding the next chunk in file order
+    int held;                    // slot lent to the caller, -1 if none
+    int err;                     // sticky I/O error
+};
+
+#ifdef __linux__
+static bool uring_drain(struct ingest_reader *r);
+#endif
+
+static void ingest_close(struct ingest_reader *r) {
+    if (!r) return;
+#ifdef __linux__
+    if (r->mode == INGEST_URING) {
+        // The kernel may still be writing into buf; if we cannot wait for
+        // it, leak the buffers rather than hand them back to malloc
+        if (!uring_drain(r)) r->buf = NULL;
+        uring_exit(&r->ring);
+    }
+#endif
+    if (r->map) munmap(r->map, r->map_len);
+    if (r->fd >= 0) close(r->fd);
+    free(r->buf);
+    free(r->slots);
+    free(r);
+}
+
+#ifdef __linux__
+static bool uring_queue_read(struct ingest_reader *r, unsigned s) {
+    struct ingest_slot *sl = &r->slots[s];
+    struct io_uring_sqe *sqe = uring_get_sqe(&r->ring);
+    if (!sqe) return false; // cannot happen: one SQE per slot at most
+    char *dst = r->buf + (size_t)s * r->chunk + sl->got;
+    sqe->opcode = r->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = r->fd;
+    sqe->off = sl->off + sl->got;
+    sqe->addr = (uint64_t)(uintptr_t)dst;
+    sqe->len = (unsigned)(sl->want - sl->got);
+    sqe->buf_index = (uint16_t)s;
+    sqe->user_data = s;
+    sl->state = SLOT_INFLIGHT;
+    r->inflight++;
+    return true;
+}
+
+// Give slot s the next chunk of the file, or park it at EOF.
+static void uring_refill(struct ingest_reader *r, unsigned s) {
+    struct ingest_slot *sl = &r->slots[s];
+    if (r->next_off >= r->size) { sl->state = SLOT_IDLE; return; }
+    sl->off = r->next_off;
+    sl->want = r->size - r->next_off < r->chunk ? (size_t)(r->size - r->next_off) : r->chunk;
+    sl->got = 0;
+    r->next_off += sl->want;
+    uring_queue_read(r, s);
+}
+
+static void uring_reap(struct ingest_reader *r) {
+    struct uring *u = &r->ring;
+    unsigned head = *u->cq_head;
+    unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+        struct ingest_slot *sl = &r->slots[cqe->user_data];
+        int res = cqe->res;
+        r->inflight--;
+        if (r->closing) {
+            sl->state = SLOT_IDLE;
+        } else if (res == -EINTR || res == -EAGAIN) {
+            uring_queue_read(r, (unsigned)cqe->user_data);
+        } else if (res < 0) {
+            if (!r->err) r->err = -res;
+            sl->state = SLOT_READY;
+        } else if (res == 0) {
+            sl->want = sl->got; // file shrank under us: stop here
+            sl->state = SLOT_READY;
+        } else {
+            sl->got += (size_t)res;
+            if (sl->got < sl->want) uring_queue_read(r, (unsigned)cqe->user_data); // short read
+            else sl->state = SLOT_READY;
+        }
+    }
+    __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Wait for a completion of every queued read. Until then the kernel may
+// write into buf, so it must not be freed or unregistered. False if the
+// ring failed and the reads can no longer be waited for.
+static bool uring_drain(struct ingest_reader *r) {
+    r->closing = true;
+    while (r->inflight) {
+        if (uring_enter(&r->ring, 1) < 0) return false;
+        uring_reap(r);
+    }
+    return true;
+}
+
+// Returns 0 or an errno value, with the failing call in *op.
+static int uring_open(struct ingest_reader *r, const char **op) {
+    *op = "io_uring_setup";
+    int rc = uring_init(&r->ring, r->qd);
+    if (rc < 0) return -rc;
+    void *mem = NULL;
+    *op = "posix_memalign";
+    if (posix_memalign(&mem, 4096, (size_t)r->qd * r->chunk) != 0) { uring_exit(&r->ring); return ENOMEM; }
+    r->buf = mem;
+    *op = "calloc";
+    r->slots = calloc(r->qd, sizeof *r->slots);
+    if (!r->slots) { uring_exit(&r->ring); return ENOMEM; }
+
+    // Registered buffers skip per-I/O page pinning. Failure (usually
+    // RLIMIT_MEMLOCK) just means plain IORING_OP_READ.
+    struct iovec *iov = calloc(r->qd, sizeof *iov);
+    if (iov) {
+        for (unsigned i = 0; i < r->qd; ++i) {
+            iov[i].iov_base = r->buf + (size_t)i * r->chunk;
+            iov[i].iov_len = r->chunk;
+        }
+        r->fixed = syscall(__NR_io_uring_register, r->ring.fd, IORING_REGISTER_BUFFERS, iov, r->qd) == 0;
+        free(iov);
+    }
+    for (unsigned s = 0; s < r->qd; ++s) uring_refill(r, s);
+    *op = "io_uring_enter";
+    rc = uring_enter(&r->ring, 0);
+    if (rc < 0) { uring_exit(&r->ring); return -rc; } // nothing was submitted
+    return 0;
+}
+
+static int uring_next(struct ingest_reader *r, struct ingest_chunk *out) {
+    if (r->held >= 0) { uring_refill(r, (unsigned)r->held); r->held = -1; }
+    // Pick up finished reads without blocking (this may requeue short ones)
+    // and submit right away, so the refill runs while the caller works on
+    // the slots that are already READY.
+    uring_reap(r);
+    if (r->ring.to_submit) {
+        int rc = uring_enter(&r->ring, 0);
+        if (rc < 0) { r->err = -rc; return -1; }
+    }
+    if (r->err) return -1;
+    if (r->deliver_off >= r->size) return 0;
+    struct ingest_slot *sl = &r->slots[r->head];
+    while (sl->state == SLOT_INFLIGHT) {
+        int rc = uring_enter(&r->ring, 1); // submit anything requeued and wait in one call
+        if (rc < 0) { r->err = -rc; return -1; }
+        uring_reap(r);
+    }
+    if (r->err) return -1;
+    if (sl->state != SLOT_READY) return 0;
+    out->data = r->buf + (size_t)r->head * r->chunk;
+    out->len = sl->got;
+    out->offset = sl->off;
+    if (sl->got < sl->want || sl->got == 0) r->size = sl->off + sl->got; // truncated file
+    r->deliver_off = sl->off + sl->got;
+    sl->state = SLOT_HELD;
+    r->held = (int)r->head;
+    r->head = (r->head + 1) % r->qd;
+    return out->len ? 1 : 0;
+}
+#endif // __linux__
+
+static int pread_next(struct ingest_reader *r, struct ingest_chunk *out) {
+    if (!r->stream && r->deliver_off >= r->size) return 0;
+    // Refresh the readahead window every queue_depth chunks
+    if (!r->stream && r->deliver_off % ((uint64_t)r->chunk * r->qd) == 0)
+        posix_fadvise(r->fd, (off_t)(r->deliver_off + r->chunk), (off_t)r->chunk * r->qd, POSIX_FADV_WILLNEED);
+    size_t got = 0;
+    while (got < r->chunk) {
+        ssize_t n = r->stream ? read(r->fd, r->buf + got, r->chunk - got)
+                              : pread(r->fd, r->buf + got, r->chunk - got, (off_t)(r->deliver_off + got));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            r->err = errno;
+            return -1;
+        }
+        if (n == 0) break;
+        got += (size_t)n;
+    }
+    if (got == 0) return 0;
+    out->data = r->buf;
+    out->len = got;
+    out->offset = r->deliver_off;
+    r->deliver_off += got;
+    return 1;
+}
+
+static int mmap_next(struct ingest_reader *r, struct ingest_chunk *out) {
+    // The previous chunk is no longer in use: let the kernel reclaim it so
+    // resident memory stays flat on large files.
+    uint64_t page = 4096, drop_to = r->deliver_off & ~(page - 1);
+    if (drop_to > r->dropped) {
+        madvise(r->map + r->dropped, (size_t)(drop_to - r->dropped), MADV_DONTNEED);
+        r->dropped = drop_to;
+    }
+    if (r->deliver_off >= r->size) return 0;
+    size_t len = r->size - r->deliver_off < r->chunk ? (size_t)(r->size - r->deliver_off) : r->chunk;
+    out->data = r->map + r->deliver_off;
+    out->len = len;
+    out->offset = r->deliver_off;
+    r->deliver_off += len;
+    return 1;
+}
+
+// Open path for chunked reading. Returns NULL and fills err on failure.
+static struct ingest_reader *ingest_open(const char *path, const struct ingest_opts *opts,
+                                         struct ingest_error *err) {
+    struct ingest_opts o = opts ? *opts : (struct ingest_opts){ INGEST_AUTO, 0, 0 };
+    struct ingest_reader *r = calloc(1, sizeof *r);
+    if (!r) { ingest_set_error(err, "calloc", errno, path); return NULL; }
+    r->fd = -1;
+    r->held = -1;
+    r->chunk = o.chunk_size ? o.chunk_size : (size_t)256 << 10;
+    r->qd = o.queue_depth ? o.queue_depth : 8;
+    snprintf(r->path, sizeof r->path, "%s", path);
+
+    r->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (r->fd < 0) { ingest_set_error(err, "open", errno, path); ingest_close(r); return NULL; }
+    struct stat st;
+    if (fstat(r->fd, &st) != 0) { ingest_set_error(err, "fstat", errno, path); ingest_close(r); return NULL; }
+    r->stream = !S_ISREG(st.st_mode);
+    r->size = r->stream ? 0 : (uint64_t)st.st_size;
+
+    enum ingest_mode mode = o.mode;
+    if (r->stream && mode != INGEST_PREAD) {
+        if (mode != INGEST_AUTO) { ingest_set_error(err, ingest_mode_name(mode), ESPIPE, path); ingest_close(r); return NULL; }
+        mode = INGEST_PREAD;
+    }
+
+#ifdef __linux__
+    if (mode == INGEST_URING || mode == INGEST_AUTO) {
+        const char *op;
+        int rc = uring_open(r, &op);
+        if (rc == 0) { r->mode = INGEST_URING; return r; }
+        if (mode == INGEST_URING) { ingest_set_error(err, op, rc, path); ingest_close(r); return NULL; }
+        free(r->buf);
+        free(r->slots);
+        r->buf = NULL;
+        r->slots = NULL;
+        r->inflight = 0;
+        mode = INGEST_PREAD; // kernel without io_uring, seccomp, ...
+    }
+#else
+    if (mode == INGEST_URING) { ingest_set_error(err, "io_uring", ENOSYS, path); ingest_close(r); return NULL; }
+    if (mode == INGEST_AUTO) mode = INGEST_PREAD;
+#endif
+
+    if (mode == INGEST_MMAP) {
+        r->mode = INGEST_MMAP;
+        if (r->size == 0) return r;
+        r->map_len = (size_t)r->size;
+        void *m = mmap(NULL, r->map_len, PROT_READ, MAP_PRIVATE, r->fd, 0);
+        if (m == MAP_FAILED) { ingest_set_error(err, "mmap", errno, path); r->map = NULL; ingest_close(r); return NULL; }
+        r->map = m;
+        madvise(r->map, r->map_len, MADV_SEQUENTIAL);
+        return r;
+    }
+
+    r->mode = INGEST_PREAD;
+    r->buf = malloc(r->chunk);
+    if (!r->buf) { ingest_set_error(err, "malloc", errno, path); ingest_close(r); return NULL; }
+    if (!r->stream) posix_fadvise(r->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return r;
+}
+
+// Iterator: 1 = *out filled (valid until the next call), 0 = end of file,
+// -1 = I/O error (details in err).
+static int ingest_next(struct ingest_reader *r, struct ingest_chunk *out, struct ingest_error *err) {
+    int rc;
+    switch (r->mode) {
+#ifdef __linux__
+        case INGEST_URING: rc = uring_next(r, out); break;
+#endif
+        case INGEST_MMAP:  rc = mmap_next(r, out); break;
+        default:           rc = pread_next(r, out); break;
+    }
+    if (rc < 0) ingest_set_error(err, r->mode == INGEST_URING ? "io_uring read" : "read", r->err, r->path);
+    return rc;
+}
+
+typedef int (*ingest_cb)(const void *data, size_t len, uint64_t offset, void *ctx);
+
+// Callback form: cb returns nonzero to stop early. Returns 0 at end of file,
+// 1 if stopped by cb, -1 on error (details in err).
+static int ingest_file(const char *path, const struct ingest_opts *opts, ingest_cb cb, void *ctx,
+                       struct ingest_error *err) {
+    struct ingest_reader *r = ingest_open(path, opts, err);
+    if (!r) return -1;
+    struct ingest_chunk c;
+    int rc;
+    while ((rc = ingest_next(r, &c, err)) > 0) {
+        if (cb(c.data, c.len, c.offset, ctx)) { rc = 1; break; }
+    }
+    ingest_close(r);
+    return rc;
+}
+
+// ---- Demo and benchmark ----
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+struct digest { uint64_t sum, bytes, chunks; };
+
+static void digest_update(struct digest *d, const void *data, size_t len) {
+    const unsigned char *p = data;
+    uint64_t s = d->sum;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) { uint64_t w; memcpy(&w, p + i, 8); s += w ^ (s >> 7); }
+    for (; i < len; ++i) s += p[i];
+    d->sum = s;
+    d->bytes += len;
+    d->chunks++;
+}
+
+static int digest_cb(const void *data, size_t len, uint64_t offset, void *ctx) {
+    (void)offset;
+    digest_update(ctx, data, len);
+    return 0;
+}
+
+static void error_demo(void) {
+    struct ingest_error e;
+    struct digest d = { 0, 0, 0 };
+    if (ingest_file("/path/that/does/not/exist", NULL, digest_cb, &d, &e) < 0) ingest_perror(&e);
+}
+
+static bool make_test_file(const char *path, size_t size) {
+    FILE *f = fopen(path, "wb");
+    if (!f) { perror("fopen"); return false; }
+    static unsigned char block[1 << 16];
+    uint32_t x = 1;
+    for (size_t i = 0; i < sizeof block; ++i) { x = x * 1103515245u + 12345u; block[i] = (unsigned char)(x >> 16); }
+    for (size_t left = size; left; ) {
+        size_t n = left < sizeof block ? left : sizeof block;
+        if (fwrite(block, 1, n, f) != n) { perror("fwrite"); fclose(f); return false; }
+        block[0]++;
+        left -= n;
+    }
+    return fclose(f) == 0;
+}
+
+// Best effort: evict the file from the page cache so runs start cold-ish
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+struct stop_after { struct digest d; uint64_t left; };
+
+static int stop_cb(const void *data, size_t len, uint64_t offset, void *ctx) {
+    struct stop_after *s = ctx;
+    (void)offset;
+    digest_update(&s->d, data, len);
+    return --s->left == 0;
+}
+
+// Stopping early closes the reader with reads still in flight (cold cache,
+// deep queue); the io_uring buffers must outlive them. Repeated so a
+// premature free shows up as heap corruption, and every run must see the
+// same prefix as pread.
+static void early_stop_check(const char *path) {
+    enum ingest_mode modes[] = { INGEST_URING, INGEST_PREAD, INGEST_MMAP };
+    struct ingest_opts o = { INGEST_PREAD, 1 << 20, 16 };
+    struct ingest_error e;
+    bool ok = true;
+    for (uint64_t k = 1; k <= 4; ++k) {
+        struct stop_after ref = { { 0, 0, 0 }, k };
+        if (ingest_file(path, &o, stop_cb, &ref, &e) != 1) { ingest_perror(&e); return; }
+        for (size_t i = 0; i < sizeof modes / sizeof modes[0]; ++i) {
+            struct ingest_opts mo = o;
+            mo.mode = modes[i];
+            for (int rep = 0; rep < 10; ++rep) {
+                struct stop_after s = { { 0, 0, 0 }, k };
+                if (modes[i] == INGEST_URING) drop_cache(path);
+                int rc = ingest_file(path, &mo, stop_cb, &s, &e);
+                if (rc < 0) { ingest_perror(&e); ok = false; break; }
+                ok &= rc == 1 && s.d.sum == ref.d.sum && s.d.bytes == ref.d.bytes && s.d.chunks == k;
+            }
+        }
+    }
+    printf("stop after 1-4 chunks, 10 runs per mode: %s\n", ok ? "ok" : "MISMATCH");
+}
+
+static void bench(const char *path) {
+    struct digest ref = { 0, 0, 0 };
+    drop_cache(path);
+    double t0 = now_sec();
+    FILE *f = fopen(path, "rb");
+    if (!f) { fprintf(stderr, "fopen failed: %s (errno=%d)\n", strerror(errno), errno); return; }
+    static char buf[1 << 18];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, f)) > 0) digest_update(&ref, buf, n);
+    fclose(f);
+    double t_fread = now_sec() - t0;
+    printf("%-9s %8.1f MB/s  (%llu bytes)\n", "fread", (double)ref.bytes / t_fread / 1e6,
+           (unsigned long long)ref.bytes);
+
+    enum ingest_mode modes[] = { INGEST_URING, INGEST_PREAD, INGEST_MMAP };
+    for (size_t i = 0; i < sizeof modes / sizeof modes[0]; ++i) {
+        struct ingest_opts o = { modes[i], 0, 0 };
+        struct digest d = { 0, 0, 0 };
+        struct ingest_error e;
+        drop_cache(path);
+        t0 = now_sec();
+        int rc = ingest_file(path, &o, digest_cb, &d, &e);
+        double dt = now_sec() - t0;
+        if (rc < 0) { ingest_perror(&e); continue; }
+        printf("%-9s %8.1f MB/s  %llu chunks %s\n", ingest_mode_name(modes[i]), (double)d.bytes / dt / 1e6,
+               (unsigned long long)d.chunks, d.sum == ref.sum && d.bytes == ref.bytes ? "ok" : "MISMATCH");
+    }
+}
+
+int main(int argc, char **argv) {
+    puts("-- Ingest: error details --");
+    error_demo();
+
+    puts("\n-- Ingest: iterator --");
+    const char *path = argc > 1 ? argv[1] : NULL;
+    char tmp[] = "/tmp/fileio_bench_XXXXXX";
+    if (!path) {
+        int fd = mkstemp(tmp);
+        if (fd < 0) { perror("mkstemp"); return 1; }
+        close(fd);
+        if (!make_test_file(tmp, (size_t)256 << 20)) { unlink(tmp); return 1; }
+        path = tmp;
+    }
+    struct ingest_error e;
+    struct ingest_reader *r = ingest_open(path, NULL, &e);
+    if (!r) { ingest_perror(&e); }
+    else {
+        struct ingest_chunk c;
+        int shown = 0, rc;
+        while ((rc = ingest_next(r, &c, &e)) > 0 && shown < 3) {
+            printf("chunk @%llu: %zu bytes via %s\n", (unsigned long long)c.offset, c.len, ingest_mode_name(r->mode));
+            ++shown;
+        }
+        if (rc < 0) ingest_perror(&e);
+        ingest_close(r);
+    }
+
+    puts("\n-- Ingest: early stop --");
+    early_stop_check(path);
+
+    puts("\n-- Benchmark --");
+    bench(path);
+
+    if (path == tmp) unlink(tmp);
+    return 0;
+}
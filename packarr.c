@@ -0,0 +1,806 @@
+// Build: gcc -O2 packarr.c -o build/packarr
+// Usage: build/packarr [count]   (default 10M values per data set)
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "cpuprobe.h"
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+#define LEN(x) (sizeof(x)/sizeof((x)[0]))
+
+// Binary container for int32 arrays, replacing print_int_array text dumps.
+//
+//   file   = header (64 B) chunk*
+//   chunk  = chunk header (32 B) payload (padded to 16 B)
+//
+// Every chunk holds up to chunk_len values (a multiple of 128) and picks its
+// own encoding:
+//   PA_RAW    little-endian int32, readable in place from a mapping
+//   PA_FOR    value - min, bit-packed          (clustered data)
+//   PA_DELTA  zig-zag(value - previous), bit-packed (sorted/slowly varying)
+// Packed payloads are 128-value blocks in a vertical 4-lane layout: value i
+// goes to 32-bit lane i % 4, so one SSE2 shift/mask yields four consecutive
+// values. A block of width b takes 16*b bytes. Headers and payloads carry
+// CRC-32C (SSE4.2 instruction when the CPU has it, table lookup otherwise).
+//
+// Functions return false/-1 with errno set; EBADMSG means a corrupt file.
+// The format is little-endian; this code assumes a little-endian host.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "packarr.c assumes a little-endian host"
+#endif
+
+#define PA_MAGIC "PKA1"
+#define PA_VERSION 1
+#define PA_CHUNK_MAGIC 0x4b4e4843u    // "CHNK"
+#define PA_BLOCK 128
+#define PA_DEFAULT_CHUNK 65536
+#define PA_MAX_CHUNK (1u << 24)       // 64 MiB of raw payload; payload_len stays well inside 32 bits
+#define PA_COUNT_UNKNOWN UINT64_MAX   // header of a stream that was never closed
+
+enum pa_enc { PA_RAW = 0, PA_FOR = 1, PA_DELTA = 2 };
+
+struct pa_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t header_size;   // sizeof(struct pa_header)
+    uint32_t chunk_len;     // values per full chunk
+    uint32_t nchunks;
+    uint64_t count;         // total values, PA_COUNT_UNKNOWN while streaming
+    uint8_t reserved[36];
+    uint32_t crc;           // CRC-32C of the bytes above
+};
+
+struct pa_chunk_hdr {
+    uint32_t magic;
+    uint32_t count;         // values in this chunk
+    uint8_t enc;            // enum pa_enc
+    uint8_t bits;           // packed width, 0..32
+    uint16_t reserved;
+    int32_t base;           // PA_FOR: minimum, PA_DELTA: first value
+    uint32_t payload_len;   // bytes, multiple of 16
+    uint32_t payload_crc;
+    uint32_t reserved2;
+    uint32_t crc;           // CRC-32C of the bytes above
+};
+
+_Static_assert(sizeof(struct pa_header) == 64, "header layout");
+_Static_assert(sizeof(struct pa_chunk_hdr) == 32, "chunk header layout");
+
+static size_t pa_round16(size_t n) { return (n + 15) & ~(size_t)15; }
+static size_t pa_blocks(size_t n) { return (n + PA_BLOCK - 1) / PA_BLOCK; }
+
+// ---- CRC-32C ----
+
+typedef uint32_t (*crc32c_fn)(uint32_t crc, const void *buf, size_t n);
+
+static uint32_t crc32c_table[8][256];
+
+// Slicing-by-8: eight table lookups per 8 input bytes.
+static uint32_t crc32c_sw(uint32_t crc, const void *buf, size_t n) {
+    const uint8_t *p = buf;
+    crc = ~crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t x;
+        memcpy(&x, p, 8);
+        x ^= crc;
+        crc = crc32c_table[7][x & 0xff] ^ crc32c_table[6][(x >> 8) & 0xff] ^
+              crc32c_table[5][(x >> 16) & 0xff] ^ crc32c_table[4][(x >> 24) & 0xff] ^
+              crc32c_table[3][(x >> 32) & 0xff] ^ crc32c_table[2][(x >> 40) & 0xff] ^
+              crc32c_table[1][(x >> 48) & 0xff] ^ crc32c_table[0][x >> 56];
+    }
+    while (n--) crc = crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+#ifdef CPU_X86
+CPU_TARGET_SSE42
+static uint32_t crc32c_sse42(uint32_t crc, const void *buf, size_t n) {
+    const uint8_t *p = buf;
+    uint64_t c = ~crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t x;
+        memcpy(&x, p, 8);
+        c = _mm_crc32_u64(c, x);
+    }
+    uint32_t c32 = (uint32_t)c;
+    while (n--) c32 = _mm_crc32_u8(c32, *p++);
+    return ~c32;
+}
+#endif
+
+static const crc32c_fn crc32c_table_fns[CPU_LEVEL_COUNT] = {
+    [CPU_LEVEL_SCALAR] = crc32c_sw,
+#ifdef CPU_X86
+    [CPU_LEVEL_SSE42]  = crc32c_sse42,
+#endif
+};
+
+static crc32c_fn crc32c = crc32c_sw;
+
+// Build the lookup tables and pick the CRC variant. Call once at startup.
+static void pa_init(void) {
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0x82f63b78u & (0u - (c & 1)));
+        crc32c_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i)
+        for (int t = 1; t < 8; ++t)
+            crc32c_table[t][i] = (crc32c_table[t - 1][i] >> 8) ^ crc32c_table[0][crc32c_table[t - 1][i] & 0xff];
+    CPU_DISPATCH(crc32c, crc32c_table_fns);
+}
+
+// ---- Bit packing (128 values, 4 vertical lanes) ----
+
+static unsigned pa_bits(uint32_t v) { return v ? 32u - (unsigned)__builtin_clz(v) : 0u; }
+
+// in[] must already fit in bits. Writes 4*bits words.
+static void pack128(const uint32_t *in, uint32_t *out, unsigned bits) {
+    if (!bits) return;
+    for (unsigned lane = 0; lane < 4; ++lane) {
+        uint32_t *w = out + lane;
+        uint64_t acc = 0;
+        unsigned fill = 0;
+        for (unsigned j = 0; j < 32; ++j) {
+            acc |= (uint64_t)in[4 * j + lane] << fill;
+            fill += bits;
+            if (fill >= 32) { *w = (uint32_t)acc; w += 4; acc >>= 32; fill -= 32; }
+        }
+    }
+}
+
+#ifdef CPU_X86
+// SSE2 is part of the x86-64 baseline, so these need no runtime dispatch.
+static void unpack128(const uint32_t *in, uint32_t *out, unsigned bits) {
+    if (!bits) { memset(out, 0, PA_BLOCK * sizeof *out); return; }
+    const __m128i mask = _mm_set1_epi32(bits == 32 ? -1 : (int)((1u << bits) - 1));
+    const __m128i *w = (const __m128i *)in;
+    __m128i cur = _mm_loadu_si128(w++);
+    unsigned shift = 0;
+    for (unsigned j = 0; j < 32; ++j) {
+        __m128i v = _mm_srl_epi32(cur, _mm_cvtsi32_si128((int)shift));
+        shift += bits;
+        if (shift >= 32) {
+            shift -= 32;
+            if (j < 31) cur = _mm_loadu_si128(w++);
+            if (shift) v = _mm_or_si128(v, _mm_sll_epi32(cur, _mm_cvtsi32_si128((int)(bits - shift))));
+        }
+        _mm_storeu_si128((__m128i *)(out + 4 * j), _mm_and_si128(v, mask));
+    }
+}
+
+static void for_decode(uint32_t *v, size_t n, uint32_t base) {
+    __m128i b = _mm_set1_epi32((int)base);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_si128((__m128i *)(v + i), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(v + i)), b));
+    for (; i < n; ++i) v[i] += base;
+}
+
+// Undo zig-zag and prefix-sum four lanes at a time; returns the last value.
+static uint32_t delta_decode(uint32_t *v, size_t n, uint32_t prev) {
+    __m128i carry = _mm_set1_epi32((int)prev);
+    const __m128i one = _mm_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+        x = _mm_xor_si128(_mm_srli_epi32(x, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(x, one)));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        _mm_storeu_si128((__m128i *)(v + i), x);
+        carry = _mm_shuffle_epi32(x, 0xff);
+    }
+    prev = (uint32_t)_mm_cvtsi128_si32(carry);
+    for (; i < n; ++i) v[i] = prev += (v[i] >> 1) ^ (0u - (v[i] & 1));
+    return prev;
+}
+#else
+static void unpack128(const uint32_t *in, uint32_t *out, unsigned bits) {
+    if (!bits) { memset(out, 0, PA_BLOCK * sizeof *out); return; }
+    uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    for (unsigned lane = 0; lane < 4; ++lane) {
+        const uint32_t *w = in + lane;
+        uint64_t acc = 0;
+        unsigned avail = 0;
+        for (unsigned j = 0; j < 32; ++j) {
+            if (avail < bits) { acc |= (uint64_t)*w << avail; w += 4; avail += 32; }
+            out[4 * j + lane] = (uint32_t)acc & mask;
+            acc >>= bits;
+            avail -= bits;
+        }
+    }
+}
+
+static void for_decode(uint32_t *v, size_t n, uint32_t base) {
+    for (size_t i = 0; i < n; ++i) v[i] += base;
+}
+
+static uint32_t delta_decode(uint32_t *v, size_t n, uint32_t prev) {
+    for (size_t i = 0; i < n; ++i) v[i] = prev += (v[i] >> 1) ^ (0u - (v[i] & 1));
+    return prev;
+}
+#endif
+
+// ---- Chunk encode/decode ----
+
+// Choose the encoding for v[0..n) and fill h (without CRCs). The packed
+// payload goes to scratch (room for pa_blocks(n) * 128 words); for PA_RAW
+// the payload is v itself.
+static const void *pa_encode_chunk(const int32_t *v, uint32_t n, uint32_t *scratch, struct pa_chunk_hdr *h) {
+    const uint32_t *u = (const uint32_t *)v;
+    int32_t lo = v[0], hi = v[0];
+    uint32_t zz_or = 0, prev = u[0];
+    for (uint32_t i = 0; i < n; ++i) {
+        if (v[i] < lo) lo = v[i];
+        if (v[i] > hi) hi = v[i];
+        uint32_t d = u[i] - prev;
+        zz_or |= (d << 1) ^ (0u - (d >> 31));
+        prev = u[i];
+    }
+    unsigned for_bits = pa_bits((uint32_t)hi - (uint32_t)lo);
+    unsigned delta_bits = pa_bits(zz_or);
+
+    memset(h, 0, sizeof *h);
+    h->magic = PA_CHUNK_MAGIC;
+    h->count = n;
+    unsigned bits = delta_bits < for_bits ? delta_bits : for_bits;
+    if (bits >= 32) {
+        h->enc = PA_RAW;
+        h->payload_len = (uint32_t)pa_round16((size_t)n * 4);
+        return v;
+    }
+
+    h->enc = delta_bits < for_bits ? PA_DELTA : PA_FOR;
+    h->bits = (uint8_t)bits;
+    h->base = h->enc == PA_FOR ? lo : v[0];
+    h->payload_len = (uint32_t)(pa_blocks(n) * 16 * bits);
+    uint32_t tmp[PA_BLOCK];
+    prev = u[0];
+    for (uint32_t b = 0; b * PA_BLOCK < n; ++b) {
+        uint32_t off = b * PA_BLOCK, m = n - off < PA_BLOCK ? n - off : PA_BLOCK;
+        if (h->enc == PA_FOR) {
+            for (uint32_t i = 0; i < m; ++i) tmp[i] = u[off + i] - (uint32_t)lo;
+        } else {
+            for (uint32_t i = 0; i < m; ++i) {
+                uint32_t d = u[off + i] - prev;
+                tmp[i] = (d << 1) ^ (0u - (d >> 31));
+                prev = u[off + i];
+            }
+        }
+        memset(tmp + m, 0, (PA_BLOCK - m) * sizeof tmp[0]);
+        pack128(tmp, scratch + (size_t)b * 4 * bits, bits);
+    }
+    return scratch;
+}
+
+static bool pa_check_chunk_hdr(const struct pa_chunk_hdr *h, uint32_t chunk_len) {
+    if (h->magic != PA_CHUNK_MAGIC || crc32c(0, h, offsetof(struct pa_chunk_hdr, crc)) != h->crc) return false;
+    if (h->count == 0 || h->count > chunk_len || h->enc > PA_DELTA || h->bits > 32) return false;
+    size_t want = h->enc == PA_RAW ? pa_round16((size_t)h->count * 4) : pa_blocks(h->count) * 16 * h->bits;
+    return h->payload_len == want;
+}
+
+// Decode a checked chunk into out[0..h->count), verifying the payload CRC.
+static bool pa_decode_chunk(const struct pa_chunk_hdr *h, const void *payload, int32_t *out) {
+    if (crc32c(0, payload, h->payload_len) != h->payload_crc) { errno = EBADMSG; return false; }
+    if (h->enc == PA_RAW) {
+        memcpy(out, payload, (size_t)h->count * 4);
+        return true;
+    }
+    uint32_t *o = (uint32_t *)out;
+    const uint32_t *in = payload;
+    uint32_t prev = (uint32_t)h->base, tmp[PA_BLOCK];
+    for (uint32_t off = 0; off < h->count; off += PA_BLOCK, in += 4 * h->bits) {
+        uint32_t m = h->count - off < PA_BLOCK ? h->count - off : PA_BLOCK;
+        uint32_t *dst = m == PA_BLOCK ? o + off : tmp; // partial tail block goes via tmp
+        unpack128(in, dst, h->bits);
+        if (h->enc == PA_FOR) for_decode(dst, m, (uint32_t)h->base);
+        else prev = delta_decode(dst, m, prev);
+        if (dst == tmp) memcpy(o + off, tmp, m * sizeof *tmp);
+    }
+    return true;
+}
+
+static bool pa_check_header(const struct pa_header *h) {
+    return memcmp(h->magic, PA_MAGIC, 4) == 0 && h->version == PA_VERSION &&
+           h->header_size == sizeof *h && h->chunk_len && h->chunk_len <= PA_MAX_CHUNK &&
+           h->chunk_len % PA_BLOCK == 0 &&
+           crc32c(0, h, offsetof(struct pa_header, crc)) == h->crc;
+}
+
+static bool write_all(int fd, const void *buf, size_t n) {
+    const char *p = buf;
+    while (n) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) { if (errno == EINTR) continue; return false; }
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+// Returns bytes read (< n only at end of file) or -1.
+static ssize_t read_full(int fd, void *buf, size_t n) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = read(fd, (char *)buf + got, n - got);
+        if (r < 0) { if (errno == EINTR) continue; return -1; }
+        if (r == 0) break;
+        got += (size_t)r;
+    }
+    return (ssize_t)got;
+}
+
+// ---- Streaming writer ----
+
+struct pa_writer {
+    int fd;
+    uint32_t chunk_len;
+    int32_t *buf;           // pending values
+    uint32_t fill;
+    uint32_t *scratch;      // packed payload
+    uint64_t count;
+    uint32_t nchunks;
+    uint64_t bytes;         // file size so far
+};
+
+static void pa_fill_header(struct pa_header *h, uint32_t chunk_len, uint32_t nchunks, uint64_t count) {
+    memset(h, 0, sizeof *h);
+    memcpy(h->magic, PA_MAGIC, 4);
+    h->version = PA_VERSION;
+    h->header_size = sizeof *h;
+    h->chunk_len = chunk_len;
+    h->nchunks = nchunks;
+    h->count = count;
+    h->crc = crc32c(0, h, offsetof(struct pa_header, crc));
+}
+
+// chunk_len 0 = PA_DEFAULT_CHUNK; other values are rounded up to 128 and
+// must not exceed PA_MAX_CHUNK (EINVAL).
+// path "-" writes to stdout; the header then keeps PA_COUNT_UNKNOWN.
+static bool pa_writer_open(struct pa_writer *w, const char *path, uint32_t chunk_len) {
+    memset(w, 0, sizeof *w);
+    if (chunk_len > PA_MAX_CHUNK) { errno = EINVAL; return false; }
+    w->chunk_len = chunk_len ? (uint32_t)(pa_blocks(chunk_len) * PA_BLOCK) : PA_DEFAULT_CHUNK;
+    w->fd = strcmp(path, "-") == 0 ? STDOUT_FILENO : open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w->fd < 0) return false;
+    w->buf = malloc((size_t)w->chunk_len * sizeof *w->buf);
+    w->scratch = malloc((size_t)w->chunk_len * sizeof *w->scratch);
+    struct pa_header h;
+    pa_fill_header(&h, w->chunk_len, 0, PA_COUNT_UNKNOWN);
+    if (!w->buf || !w->scratch || !write_all(w->fd, &h, sizeof h)) {
+        int e = w->buf && w->scratch ? errno : ENOMEM;
+        free(w->buf);
+        free(w->scratch);
+        if (w->fd != STDOUT_FILENO) close(w->fd);
+        errno = e;
+        return false;
+    }
+    w->bytes = sizeof h;
+    return true;
+}
+
+static bool pa_write_chunk(struct pa_writer *w, const int32_t *v, uint32_t n) {
+    static const char zeros[16];
+    struct pa_chunk_hdr h;
+    const void *payload = pa_encode_chunk(v, n, w->scratch, &h);
+    size_t data = h.enc == PA_RAW ? (size_t)n * 4 : h.payload_len;
+    if (h.enc == PA_RAW && data != h.payload_len) {
+        // CRC covers the zero padding too
+        h.payload_crc = crc32c(crc32c(0, payload, data), zeros, h.payload_len - data);
+    } else {
+        h.payload_crc = crc32c(0, payload, data);
+    }
+    h.crc = crc32c(0, &h, offsetof(struct pa_chunk_hdr, crc));
+    if (!write_all(w->fd, &h, sizeof h) || !write_all(w->fd, payload, data) ||
+        !write_all(w->fd, zeros, h.payload_len - data)) return false;
+    w->bytes += sizeof h + h.payload_len;
+    w->count += n;
+    w->nchunks++;
+    return true;
+}
+
+static bool pa_writer_append(struct pa_writer *w, const int32_t *v, size_t n) {
+    // Full chunks straight from the caller's array, no staging copy
+    if (w->fill == 0) {
+        for (; n >= w->chunk_len; v += w->chunk_len, n -= w->chunk_len)
+            if (!pa_write_chunk(w, v, w->chunk_len)) return false;
+    }
+    while (n) {
+        uint32_t take = w->chunk_len - w->fill;
+        if (take > n) take = (uint32_t)n;
+        memcpy(w->buf + w->fill, v, (size_t)take * sizeof *v);
+        w->fill += take;
+        v += take;
+        n -= take;
+        if (w->fill == w->chunk_len) {
+            if (!pa_write_chunk(w, w->buf, w->fill)) return false;
+            w->fill = 0;
+        }
+    }
+    return true;
+}
+
+// Flush the last chunk and patch the header with the final counts.
+static bool pa_writer_close(struct pa_writer *w) {
+    bool ok = w->fill == 0 || pa_write_chunk(w, w->buf, w->fill);
+    if (ok && w->fd != STDOUT_FILENO) {
+        struct pa_header h;
+        pa_fill_header(&h, w->chunk_len, w->nchunks, w->count);
+        ok = pwrite(w->fd, &h, sizeof h, 0) == (ssize_t)sizeof h;
+    }
+    int e = errno;
+    if (w->fd != STDOUT_FILENO && close(w->fd) != 0 && ok) { ok = false; e = errno; }
+    free(w->buf);
+    free(w->scratch);
+    errno = e;
+    return ok;
+}
+
+static bool pa_save(const char *path, const int32_t *a, size_t n, uint32_t chunk_len) {
+    struct pa_writer w;
+    if (!pa_writer_open(&w, path, chunk_len)) return false;
+    bool ok = pa_writer_append(&w, a, n);
+    return pa_writer_close(&w) && ok;
+}
+
+// ---- Streaming reader ----
+
+struct pa_reader {
+    int fd;
+    struct pa_header h;
+    void *payload;          // chunk_len * 4 bytes, enough for any valid chunk
+    uint64_t seen;
+};
+
+static bool pa_reader_open(struct pa_reader *r, const char *path) {
+    memset(r, 0, sizeof *r);
+    r->fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY);
+    if (r->fd < 0) return false;
+    ssize_t got = read_full(r->fd, &r->h, sizeof r->h);
+    int e = got < 0 ? errno : EBADMSG;
+    if (got == (ssize_t)sizeof r->h && pa_check_header(&r->h)) {
+        r->payload = malloc((size_t)r->h.chunk_len * 4);
+        if (r->payload) return true;
+        e = ENOMEM;
+    }
+    if (r->fd != STDIN_FILENO) close(r->fd);
+    errno = e;
+    return false;
+}
+
+// Decode the next chunk into out (room for h.chunk_len values).
+// Returns 1 with *n set, 0 at the end, -1 on error.
+static int pa_reader_next(struct pa_reader *r, int32_t *out, size_t *n) {
+    struct pa_chunk_hdr ch;
+    ssize_t got = read_full(r->fd, &ch, sizeof ch);
+    if (got < 0) return -1;
+    if (got == 0) {
+        if (r->h.count != PA_COUNT_UNKNOWN && r->seen != r->h.count) { errno = EBADMSG; return -1; }
+        return 0;
+    }
+    if (got != (ssize_t)sizeof ch || !pa_check_chunk_hdr(&ch, r->h.chunk_len)) { errno = EBADMSG; return -1; }
+    got = read_full(r->fd, r->payload, ch.payload_len);
+    if (got < 0) return -1;
+    if (got != (ssize_t)ch.payload_len) { errno = EBADMSG; return -1; }
+    if (!pa_decode_chunk(&ch, r->payload, out)) return -1;
+    r->seen += ch.count;
+    *n = ch.count;
+    return 1;
+}
+
+static void pa_reader_close(struct pa_reader *r) {
+    if (r->fd != STDIN_FILENO) close(r->fd);
+    free(r->payload);
+}
+
+// ---- Memory-mapped reader ----
+
+struct pa_map {
+    const uint8_t *base;
+    size_t size;
+    const struct pa_header *h;
+    const struct pa_chunk_hdr **chunks; // nchunks entries, pointing into the mapping
+    uint64_t *first;                    // index of each chunk's first value
+    uint32_t nchunks;
+};
+
+// Map a closed file and check every header. Payload CRCs are checked when a
+// chunk is decoded or by pa_map_verify(); pa_map_raw() hands out the mapped
+// bytes as they are.
+static bool pa_map_open(struct pa_map *m, const char *path) {
+    memset(m, 0, sizeof *m);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { int e = errno; close(fd); errno = e; return false; }
+    if ((size_t)st.st_size < sizeof(struct pa_header)) { close(fd); errno = EBADMSG; return false; }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int e = errno;
+    close(fd);
+    if (p == MAP_FAILED) { errno = e; return false; }
+    madvise(p, (size_t)st.st_size, MADV_WILLNEED);
+    m->base = p;
+    m->size = (size_t)st.st_size;
+    m->h = p;
+
+    e = EBADMSG;
+    if (!pa_check_header(m->h) || m->h->count == PA_COUNT_UNKNOWN) goto fail;
+    m->nchunks = m->h->nchunks;
+    // Untrusted count: every chunk needs at least its header in the file
+    if (m->nchunks > (m->size - sizeof *m->h) / sizeof(struct pa_chunk_hdr)) goto fail;
+    m->chunks = malloc(((size_t)m->nchunks + 1) * sizeof *m->chunks);
+    m->first = malloc(((size_t)m->nchunks + 1) * sizeof *m->first);
+    if (!m->chunks || !m->first) { e = ENOMEM; goto fail; }
+    size_t off = sizeof *m->h;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < m->nchunks; ++i) {
+        if (m->size - off < sizeof(struct pa_chunk_hdr)) goto fail;
+        const struct pa_chunk_hdr *ch = (const struct pa_chunk_hdr *)(m->base + off);
+        if (!pa_check_chunk_hdr(ch, m->h->chunk_len)) goto fail;
+        off += sizeof *ch;
+        if (m->size - off < ch->payload_len) goto fail;
+        off += ch->payload_len;
+        m->chunks[i] = ch;
+        m->first[i] = total;
+        total += ch->count;
+    }
+    m->first[m->nchunks] = total;
+    if (total != m->h->count || off != m->size) goto fail;
+    return true;
+fail:
+    munmap((void *)m->base, m->size);
+    free(m->chunks);
+    free(m->first);
+    memset(m, 0, sizeof *m);
+    errno = e;
+    return false;
+}
+
+static void pa_map_close(struct pa_map *m) {
+    if (m->base) munmap((void *)m->base, m->size);
+    free(m->chunks);
+    free(m->first);
+    memset(m, 0, sizeof *m);
+}
+
+static const void *pa_map_payload(const struct pa_map *m, uint32_t i) { return m->chunks[i] + 1; }
+
+// Zero-copy view of a PA_RAW chunk, NULL for packed ones.
+static const int32_t *pa_map_raw(const struct pa_map *m, uint32_t i, size_t *n) {
+    if (m->chunks[i]->enc != PA_RAW) return NULL;
+    *n = m->chunks[i]->count;
+    return pa_map_payload(m, i);
+}
+
+static bool pa_map_decode(const struct pa_map *m, uint32_t i, int32_t *out) {
+    return pa_decode_chunk(m->chunks[i], pa_map_payload(m, i), out);
+}
+
+// Decode everything into out (room for h->count values).
+static bool pa_map_read(const struct pa_map *m, int32_t *out) {
+    for (uint32_t i = 0; i < m->nchunks; ++i)
+        if (!pa_map_decode(m, i, out + m->first[i])) return false;
+    return true;
+}
+
+static bool pa_map_verify(const struct pa_map *m) {
+    for (uint32_t i = 0; i < m->nchunks; ++i) {
+        const struct pa_chunk_hdr *ch = m->chunks[i];
+        if (crc32c(0, pa_map_payload(m, i), ch->payload_len) != ch->payload_crc) { errno = EBADMSG; return false; }
+    }
+    return true;
+}
+
+// ---- Demos ----
+
+static const char *enc_name(unsigned e) {
+    static const char *names[] = {"raw", "for", "delta"};
+    return e < LEN(names) ? names[e] : "?";
+}
+
+static void roundtrip_demo(const char *path) {
+    int32_t a[300];
+    for (int i = 0; i < 300; ++i) a[i] = i < 200 ? 1000 + 3 * i : (int32_t)(i * 2654435761u);
+    if (!pa_save(path, a, LEN(a), 128)) { perror("pa_save"); return; }
+
+    struct pa_map m;
+    if (!pa_map_open(&m, path)) { perror("pa_map_open"); return; }
+    printf("%llu values in %u chunks, %zu bytes (text would be ~%zu)\n",
+           (unsigned long long)m.h->count, m.nchunks, m.size, LEN(a) * 12);
+    for (uint32_t i = 0; i < m.nchunks; ++i)
+        printf("  chunk %u: %3u values, %-5s %2u bits, %4u payload bytes\n", i, m.chunks[i]->count,
+               enc_name(m.chunks[i]->enc), m.chunks[i]->bits, m.chunks[i]->payload_len);
+    int32_t back[LEN(a)];
+    bool ok = pa_map_verify(&m) && pa_map_read(&m, back) && memcmp(a, back, sizeof a) == 0;
+    printf("roundtrip: %s\n", ok ? "ok" : "MISMATCH");
+
+    // Raw chunks are used straight from the page cache
+    int64_t raw_sum = 0;
+    size_t raw_n = 0;
+    for (uint32_t i = 0; i < m.nchunks; ++i) {
+        size_t k;
+        const int32_t *p = pa_map_raw(&m, i, &k);
+        if (!p) continue;
+        for (size_t j = 0; j < k; ++j) raw_sum += p[j];
+        raw_n += k;
+    }
+    printf("zero-copy sum over %zu raw values: %lld\n", raw_n, (long long)raw_sum);
+    pa_map_close(&m);
+
+    // Flip one payload byte: the chunk CRC catches it
+    int fd = open(path, O_RDWR);
+    if (fd >= 0) {
+        off_t at = (off_t)(sizeof(struct pa_header) + sizeof(struct pa_chunk_hdr) + 5);
+        char c;
+        if (pread(fd, &c, 1, at) == 1) { c ^= 0x40; if (pwrite(fd, &c, 1, at) != 1) perror("pwrite"); }
+        close(fd);
+    }
+    if (pa_map_open(&m, path)) {
+        if (!pa_map_read(&m, back)) printf("corrupted file: %s\n", strerror(errno));
+        pa_map_close(&m);
+    }
+
+    // A header with a valid CRC but an impossible chunk count is rejected
+    // before anything is sized from it
+    struct pa_header h;
+    fd = open(path, O_RDWR);
+    if (fd >= 0 && pread(fd, &h, sizeof h, 0) == (ssize_t)sizeof h) {
+        h.nchunks = UINT32_MAX;
+        h.crc = crc32c(0, &h, offsetof(struct pa_header, crc));
+        if (pwrite(fd, &h, sizeof h, 0) != (ssize_t)sizeof h) perror("pwrite");
+    }
+    if (fd >= 0) close(fd);
+    bool rejected = !pa_map_open(&m, path) && errno == EBADMSG;
+    if (!rejected) pa_map_close(&m);
+    printf("nchunks = UINT32_MAX: %s\n", rejected ? "rejected, ok" : "MISMATCH");
+}
+
+// ---- Benchmark ----
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+// The print_int_array format: "[1, 2, 3]\n"
+static bool text_save(const char *path, const int32_t *a, size_t n) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fputc('[', f);
+    for (size_t i = 0; i < n; ++i) fprintf(f, "%d%s", a[i], (i + 1 < n) ? ", " : "");
+    fputs("]\n", f);
+    return fclose(f) == 0;
+}
+
+static size_t text_load(const char *path, int32_t *out, size_t cap) {
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    rewind(f);
+    char *s = malloc((size_t)len + 1);
+    size_t n = 0;
+    if (s && fread(s, 1, (size_t)len, f) == (size_t)len) {
+        s[len] = '\0';
+        char *p = s + 1, *end;
+        while (n < cap) {
+            long v = strtol(p, &end, 10);
+            if (end == p) break;
+            out[n++] = (int32_t)v;
+            p = end + 1; // skip ','
+        }
+    }
+    free(s);
+    fclose(f);
+    return n;
+}
+
+static void bench_one(const char *name, const int32_t *a, size_t n, int32_t *back, const char *dir) {
+    char tpath[256], bpath[256];
+    snprintf(tpath, sizeof tpath, "%s/packarr_%s.txt", dir, name);
+    snprintf(bpath, sizeof bpath, "%s/packarr_%s.pka", dir, name);
+
+    double t0 = now_sec();
+    bool ok = text_save(tpath, a, n);
+    double t_tw = now_sec() - t0;
+    t0 = now_sec();
+    size_t got = ok ? text_load(tpath, back, n) : 0;
+    double t_tr = now_sec() - t0;
+    bool text_ok = got == n && memcmp(a, back, n * sizeof *a) == 0;
+
+    t0 = now_sec();
+    ok = pa_save(bpath, a, n, 0);
+    double t_bw = now_sec() - t0;
+    if (!ok) { perror("pa_save"); unlink(tpath); return; }
+
+    memset(back, 0, n * sizeof *back);
+    t0 = now_sec();
+    struct pa_map m;
+    bool map_ok = pa_map_open(&m, bpath) && pa_map_read(&m, back);
+    double t_map = now_sec() - t0;
+    map_ok = map_ok && memcmp(a, back, n * sizeof *a) == 0;
+    if (m.base) pa_map_close(&m);
+
+    memset(back, 0, n * sizeof *back);
+    t0 = now_sec();
+    struct pa_reader r;
+    bool stream_ok = pa_reader_open(&r, bpath);
+    if (stream_ok) {
+        size_t k, at = 0;
+        int rc;
+        while ((rc = pa_reader_next(&r, back + at, &k)) == 1) at += k;
+        stream_ok = rc == 0 && at == n;
+        pa_reader_close(&r);
+    }
+    double t_stream = now_sec() - t0;
+    stream_ok = stream_ok && memcmp(a, back, n * sizeof *a) == 0;
+
+    double mb = (double)n * 4 / 1e6; // throughput in terms of the int32 data
+    printf("%-9s text %7.1f MB (w %6.0f MB/s, strtol %6.0f MB/s) %s\n", name, (double)file_size(tpath) / 1e6,
+           mb / t_tw, mb / t_tr, text_ok ? "ok" : "MISMATCH");
+    printf("%-9s pka  %7.1f MB (w %6.0f MB/s, mmap %6.0f MB/s, stream %6.0f MB/s) %s\n", "",
+           (double)file_size(bpath) / 1e6, mb / t_bw, mb / t_map, mb / t_stream,
+           map_ok && stream_ok ? "ok" : "MISMATCH");
+    unlink(tpath);
+    unlink(bpath);
+}
+
+static void bench(size_t n) {
+    int32_t *a = malloc(n * sizeof *a), *back = malloc(n * sizeof *back);
+    if (!a || !back) { perror("malloc"); free(a); free(back); return; }
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    uint32_t x = 12345;
+#define RND() (x ^= x << 13, x ^= x >> 17, x ^= x << 5, x)
+
+    int32_t v = -1000000; // sorted ids with small gaps
+    for (size_t i = 0; i < n; ++i) a[i] = v += (int32_t)(RND() % 16);
+    bench_one("sorted", a, n, back, dir);
+
+    for (size_t i = 0; i < n; ++i) a[i] = 500000 + (int32_t)((i / 4096) * 37 % 9000) + (int32_t)(RND() % 1000);
+    bench_one("clustered", a, n, back, dir);
+
+    for (size_t i = 0; i < n; ++i) a[i] = (int32_t)RND();
+    bench_one("random", a, n, back, dir);
+#undef RND
+    free(a);
+    free(back);
+}
+
+int main(int argc, char **argv) {
+    pa_init();
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    if (!n) n = 10000000;
+
+    puts("-- Packed Arrays --");
+    printf("crc32c: %s\n", crc32c == crc32c_sw ? "table (slicing-by-8)" : "sse4.2");
+    char tmp[] = "/tmp/packarr_demo_XXXXXX";
+    int fd = mkstemp(tmp);
+    if (fd < 0) { perror("mkstemp"); return 1; }
+    close(fd);
+    roundtrip_demo(tmp);
+    unlink(tmp);
+
+    printf("\n-- Benchmark: %zu int32 values --\n", n);
+    bench(n);
+    return 0;
+}
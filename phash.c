@@ -0,0 +1,324 @@
+// Build: gcc -O2 phash.c -o build/phash
+// Usage: build/phash                       demo + benchmark
+//        build/phash gen NAME:k1,k2,... ...  print a header of static tables
+// phash_kw.h was produced with:
+//   build/phash gen day:Mon,Tue,Wed,Thu,Fri,Sat,Sun cmd:0,1,2,3,4,5,6 color:red,green,blue > phash_kw.h
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "phash.h"
+#include "phash_kw.h"
+
+#define LEN(x) (sizeof(x)/sizeof((x)[0]))
+#define MAX_KEYS 4096
+#define MAX_NAME 48 // set names become C identifiers, upper-cased into a fixed buffer
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// ---- Generator ----
+
+static bool is_identifier(const char *s) {
+    if (!isalpha((unsigned char)*s) && *s != '_') return false;
+    for (; *s; ++s) if (!isalnum((unsigned char)*s) && *s != '_') return false;
+    return true;
+}
+
+static void emit_string(const char *s) {
+    putchar('"');
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') printf("\\%c", *s);
+        else if (isprint((unsigned char)*s)) putchar(*s);
+        else printf("\\%03o", (unsigned char)*s);
+    }
+    putchar('"');
+}
+
+// Every identifier the generated header declares, across all sets, so that
+// collisions are reported before anything is printed: keys that differ only
+// in case (A_MON twice), a key named COUNT (A_COUNT), or sets whose names
+// and keys paste into the same identifier ("a" key "b_c", "a_b" key "c").
+static char **claimed;
+static size_t nclaimed;
+
+static bool claim(const char *id) {
+    for (size_t i = 0; i < nclaimed; ++i)
+        if (strcmp(claimed[i], id) == 0) return false;
+    char **grown = realloc(claimed, (nclaimed + 1) * sizeof *claimed);
+    if (!grown) return false;
+    claimed = grown;
+    if (!(claimed[nclaimed] = strdup(id))) return false;
+    ++nclaimed;
+    return true;
+}
+
+static bool claim_all(const char *set, const char *fmt, const char *a, const char *b) {
+    char id[MAX_NAME + 2 + 256 + 16];
+    snprintf(id, sizeof id, fmt, a, b);
+    if (claim(id)) return true;
+    fprintf(stderr, "set '%s': identifier %s collides with another one in the header\n", set, id);
+    return false;
+}
+
+// Checks "name:k1,k2,..." before anything is printed: the name is pasted
+// into identifiers and the include guard, so it must be a C identifier, and
+// the keys must be accepted by ph_build (at least one, no duplicates, none
+// over 255 bytes; empty keys cannot be written here, as strtok skips them).
+static bool check_set(const char *spec) {
+    const char *colon = strchr(spec, ':');
+    size_t len = colon ? (size_t)(colon - spec) : 0;
+    char name[MAX_NAME + 1], upper[MAX_NAME + 1];
+    if (!colon || !len || len > MAX_NAME) {
+        fprintf(stderr, "bad set '%s' (expected NAME:k1,k2,..., NAME up to %d chars)\n", spec, MAX_NAME);
+        return false;
+    }
+    memcpy(name, spec, len);
+    name[len] = '\0';
+    if (!is_identifier(name)) {
+        fprintf(stderr, "bad set name '%s' (must be a C identifier)\n", name);
+        return false;
+    }
+    for (size_t i = 0; i <= len; ++i) upper[i] = (char)toupper((unsigned char)name[i]);
+
+    char *list = strdup(colon + 1);
+    static const char *keys[MAX_KEYS];
+    size_t n = 0;
+    bool ok = list != NULL, ids = true;
+    for (char *tok = ok ? strtok(list, ",") : NULL; ok && tok; tok = strtok(NULL, ",")) {
+        if (n == MAX_KEYS) { fprintf(stderr, "%s: more than %d keys\n", name, MAX_KEYS); ok = false; break; }
+        if (strlen(tok) > 255) { fprintf(stderr, "%s: key '%.32s...' is over 255 bytes\n", name, tok); ok = false; break; }
+        for (size_t j = 0; j < n && ok; ++j)
+            if (strcmp(keys[j], tok) == 0) { fprintf(stderr, "%s: duplicate key '%s'\n", name, tok); ok = false; }
+        if (!ok) break;
+        keys[n++] = tok;
+        ids = ids && is_identifier(tok);
+    }
+    if (ok && !n) { fprintf(stderr, "%s: no keys\n", name); ok = false; }
+
+    static const char *const tables[] = {"%s_names", "%s_disp", "%s_slot_names", "%s_slot_lens", "%s_slot_ids", "%s_phash"};
+    for (size_t t = 0; ok && t < LEN(tables); ++t) ok = claim_all(name, tables[t], name, "");
+    ok = ok && claim_all(name, "%s_COUNT", upper, "");
+    for (size_t i = 0; ok && ids && i < n; ++i) {
+        char key_upper[256];
+        size_t k = 0;
+        for (const char *p = keys[i]; *p; ++p) key_upper[k++] = (char)toupper((unsigned char)*p);
+        key_upper[k] = '\0';
+        ok = claim_all(name, "%s_%s", upper, key_upper);
+    }
+    free(list);
+    return ok;
+}
+
+// Emit one keyword set "name:k1,k2,..." (already checked) as static const tables.
+static bool emit_set(char *spec) {
+    char *colon = strchr(spec, ':');
+    *colon = '\0';
+    const char *name = spec;
+
+    static const char *keys[MAX_KEYS];
+    size_t n = 0;
+    for (char *tok = strtok(colon + 1, ","); tok; tok = strtok(NULL, ",")) {
+        if (n == MAX_KEYS) { fprintf(stderr, "%s: too many keys\n", name); return false; }
+        keys[n++] = tok;
+    }
+
+    struct phash_built pb;
+    if (!ph_build(&pb, keys, n)) {
+        fprintf(stderr, "%s: cannot build the tables (out of memory)\n", name); // keys were checked
+        return false;
+    }
+
+    char upper[64];
+    snprintf(upper, sizeof upper, "%s", name);
+    for (char *p = upper; *p; ++p) *p = (char)toupper((unsigned char)*p);
+
+    printf("\n// %s: %zu keys, %u buckets\n", name, n, pb.ph.nbuckets);
+    printf("enum { %s_COUNT = %zu };\n", upper, n);
+    bool ids = true;
+    for (size_t i = 0; i < n && ids; ++i) ids = is_identifier(keys[i]);
+    if (ids) {
+        printf("enum %s_id {", name);
+        for (size_t i = 0; i < n; ++i) {
+            printf("%s %s_", i ? "," : "", upper);
+            for (const char *p = keys[i]; *p; ++p) putchar(toupper((unsigned char)*p));
+        }
+        printf(" };\n");
+    }
+
+    printf("static const char *const %s_names[%zu] = {", name, n);
+    for (size_t i = 0; i < n; ++i) { printf(i ? ", " : " "); emit_string(keys[i]); }
+    printf(" };\n");
+
+    printf("static const uint32_t %s_disp[%u] = {", name, pb.ph.nbuckets);
+    for (uint32_t b = 0; b < pb.ph.nbuckets; ++b) printf("%s%uu", b ? ", " : " ", pb.disp[b]);
+    printf(" };\n");
+
+    printf("static const char *const %s_slot_names[%zu] = {", name, n);
+    for (size_t i = 0; i < n; ++i) { printf(i ? ", " : " "); emit_string(pb.slot_names[i]); }
+    printf(" };\n");
+
+    printf("static const uint8_t %s_slot_lens[%zu] = {", name, n);
+    for (size_t i = 0; i < n; ++i) printf("%s%u", i ? ", " : " ", pb.slot_lens[i]);
+    printf(" };\n");
+
+    printf("static const uint16_t %s_slot_ids[%zu] = {", name, n);
+    for (size_t i = 0; i < n; ++i) printf("%s%u", i ? ", " : " ", pb.slot_ids[i]);
+    printf(" };\n");
+
+    printf("static const struct phash %s_phash = {\n"
+           "    %zu, %u, %s_disp, %s_slot_names, %s_slot_lens, %s_slot_ids, %s_names\n"
+           "};\n", name, n, pb.ph.nbuckets, name, name, name, name, name);
+
+    ph_free(&pb);
+    return true;
+}
+
+static int generate(int argc, char **argv) {
+    if (!argc) { fprintf(stderr, "gen: no keyword sets given\n"); return 1; }
+    for (int i = 0; i < argc; ++i)
+        if (!check_set(argv[i])) return 1;
+
+    // Guard from the set names (the first few if there are many), so headers
+    // for different sets can be included together
+    char guard[256] = "PHASH";
+    size_t g = strlen(guard);
+    for (int i = 0; i < argc && g + 1 + MAX_NAME + sizeof "_H" <= sizeof guard; ++i) {
+        guard[g++] = '_';
+        for (const char *p = argv[i]; *p != ':'; ++p) guard[g++] = (char)toupper((unsigned char)*p);
+    }
+    memcpy(guard + g, "_H", sizeof "_H");
+
+    printf("// Generated by: build/phash gen");
+    for (int i = 0; i < argc; ++i) printf(" %s", argv[i]);
+    printf("\n// Do not edit; regenerate instead.\n");
+    printf("#ifndef %s\n#define %s\n\n#include \"phash.h\"\n", guard, guard);
+    for (int i = 0; i < argc; ++i)
+        if (!emit_set(argv[i])) return 1;
+    printf("\n#endif // %s\n", guard);
+    return 0;
+}
+
+// ---- Demos ----
+
+static void lookup_demo(void) {
+    const char *probe[] = {"Mon", "Sun", "Fri", "Weekend", "mon", ""};
+    for (size_t i = 0; i < LEN(probe); ++i)
+        printf("day '%s' -> %d\n", probe[i], ph_lookup_cstr(&day_phash, probe[i]));
+    for (int id = 0; id < DAY_COUNT; ++id) printf("%s ", ph_name(&day_phash, id));
+    printf("\ncolor 'blue' -> %d, color id %d -> %s\n",
+           ph_lookup_cstr(&color_phash, "blue"), COLOR_GREEN, ph_name(&color_phash, COLOR_GREEN));
+
+    // Runtime-built table over the same keys agrees with the generated one
+    struct phash_built pb;
+    if (ph_build(&pb, day_names, DAY_COUNT)) {
+        printf("runtime build: 'Thu' -> %d\n", ph_lookup_cstr(&pb.ph, "Thu"));
+        ph_free(&pb);
+    }
+}
+
+// Menu dispatch from consoleio.c: one probe instead of a strcmp chain
+static void menu_demo(void) {
+    static const char *const actions[CMD_COUNT] = {
+        "Quit", "Echo a line", "Read integer", "scanf basics",
+        "Formatting examples", "Prompt loop", "Read single character",
+    };
+    const char *inputs[] = {"2", "6", "0", "9", "42"};
+    for (size_t i = 0; i < LEN(inputs); ++i) {
+        int id = ph_lookup_cstr(&cmd_phash, inputs[i]);
+        printf("menu '%s' -> %s\n", inputs[i], id >= 0 ? actions[id] : "Unknown option.");
+    }
+}
+
+// ---- Benchmark ----
+
+static int day_strcmp_chain(const char *s) {
+    if (strcmp(s, "Mon") == 0) return 0;
+    else if (strcmp(s, "Tue") == 0) return 1;
+    else if (strcmp(s, "Wed") == 0) return 2;
+    else if (strcmp(s, "Thu") == 0) return 3;
+    else if (strcmp(s, "Fri") == 0) return 4;
+    else if (strcmp(s, "Sat") == 0) return 5;
+    else if (strcmp(s, "Sun") == 0) return 6;
+    return -1;
+}
+
+static const char *day_switch(int id) {
+    switch (id) {
+        case 0: return "Mon";
+        case 1: return "Tue";
+        case 2: return "Wed";
+        case 3: return "Thu";
+        case 4: return "Fri";
+        case 5: return "Sat";
+        case 6: return "Sun";
+        default: return "?";
+    }
+}
+
+static void bench(void) {
+    enum { Q = 4096 };
+    static const char *words[] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun", "Weekend", "Xyz"};
+    static const char *query[Q];
+    static size_t qlen[Q];
+    static int qid[Q];
+    uint32_t x = 12345;
+    for (int i = 0; i < Q; ++i) {
+        x = x * 1103515245u + 12345u;
+        query[i] = words[(x >> 16) % LEN(words)];
+        qlen[i] = strlen(query[i]);
+        qid[i] = (int)((x >> 8) % DAY_COUNT);
+    }
+    int reps = 5000;
+    long sum = 0;
+
+    double t0 = now_sec();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < Q; ++i) sum += day_strcmp_chain(query[i]);
+    double t_chain = now_sec() - t0;
+
+    long sum2 = 0;
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < Q; ++i) sum2 += ph_lookup(&day_phash, query[i], qlen[i]);
+    double t_ph = now_sec() - t0;
+
+    size_t sum3 = 0;
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < Q; ++i) sum3 += (size_t)day_switch(qid[i])[0];
+    double t_sw = now_sec() - t0;
+
+    size_t sum4 = 0;
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r)
+        for (int i = 0; i < Q; ++i) sum4 += (size_t)ph_name(&day_phash, qid[i])[0];
+    double t_tab = now_sec() - t0;
+
+    double q = (double)reps * Q;
+    printf("string->id strcmp chain: %6.2f ns/lookup\n", t_chain / q * 1e9);
+    printf("string->id perfect hash: %6.2f ns/lookup %s\n", t_ph / q * 1e9, sum == sum2 ? "ok" : "MISMATCH");
+    printf("id->string switch:       %6.2f ns/lookup\n", t_sw / q * 1e9);
+    printf("id->string table:        %6.2f ns/lookup %s\n", t_tab / q * 1e9, sum3 == sum4 ? "ok" : "MISMATCH");
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "gen") == 0) return generate(argc - 2, argv + 2);
+
+    puts("-- Perfect Hash Lookup --");
+    lookup_demo();
+
+    puts("\n-- Menu Dispatch --");
+    menu_demo();
+
+    puts("\n-- Benchmark --");
+    bench();
+
+    return 0;
+}
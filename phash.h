@@ -0,0 +1,192 @@
+#ifndef PHASH_H
+#define PHASH_H
+
+// Minimal perfect hashing for small fixed keyword sets (hash-and-displace).
+//
+// A key is hashed once to 64 bits. The high half picks a bucket, the low half
+// is xored with that bucket's displacement and mixed to pick a slot. The
+// builder chooses displacements so every key gets its own slot in a table of
+// exactly n entries, so a lookup is one probe plus one memcmp to reject
+// strings that are not in the set.
+//
+// Tables are normally generated at build time (build/phash gen ...) into a
+// header of static const data; ph_build() does the same at runtime.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct phash {
+    uint32_t n;                     // number of keys == number of slots
+    uint32_t nbuckets;
+    const uint32_t *disp;           // bucket -> displacement
+    const char *const *slot_names;  // slot -> key
+    const uint8_t *slot_lens;       // slot -> key length (keys up to 255 bytes)
+    const uint16_t *slot_ids;       // slot -> id (position in the input list)
+    const char *const *names;       // id -> key
+};
+
+// FNV-1a over the bytes followed by a 64-bit finalizer so both halves are usable.
+static inline uint64_t ph_hash64(const char *s, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 33; h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint32_t ph_mix32(uint32_t x) {
+    x ^= x >> 16; x *= 0x85ebca6bu;
+    x ^= x >> 13; x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+// Map a 32-bit hash onto [0, n) with a multiply instead of a division.
+static inline uint32_t ph_reduce(uint32_t h, uint32_t n) {
+    return (uint32_t)(((uint64_t)h * n) >> 32);
+}
+
+static inline uint32_t ph_slot(const struct phash *ph, uint64_t h) {
+    uint32_t b = ph_reduce((uint32_t)(h >> 32), ph->nbuckets);
+    return ph_reduce(ph_mix32((uint32_t)h ^ ph->disp[b]), ph->n);
+}
+
+// String -> id, or -1 when s is not one of the keys.
+static inline int ph_lookup(const struct phash *ph, const char *s, size_t len) {
+    uint32_t slot = ph_slot(ph, ph_hash64(s, len));
+    if (ph->slot_lens[slot] != len || memcmp(ph->slot_names[slot], s, len) != 0) return -1;
+    return ph->slot_ids[slot];
+}
+
+static inline int ph_lookup_cstr(const struct phash *ph, const char *s) {
+    return ph_lookup(ph, s, strlen(s));
+}
+
+// Id -> string, or NULL when out of range.
+static inline const char *ph_name(const struct phash *ph, int id) {
+    return (id >= 0 && (uint32_t)id < ph->n) ? ph->names[id] : NULL;
+}
+
+// Owning storage for a table built at runtime.
+struct phash_built {
+    struct phash ph;
+    uint32_t *disp;
+    const char **slot_names;
+    uint8_t *slot_lens;
+    uint16_t *slot_ids;
+};
+
+static inline void ph_free(struct phash_built *pb) {
+    free(pb->disp);
+    free((void *)pb->slot_names);
+    free(pb->slot_lens);
+    free(pb->slot_ids);
+    memset(pb, 0, sizeof *pb);
+}
+
+struct ph_bucket { uint32_t index, count, first; };
+
+static inline int ph_cmp_bucket(const void *a, const void *b) {
+    const struct ph_bucket *x = (const struct ph_bucket *)a, *y = (const struct ph_bucket *)b;
+    if (x->count != y->count) return x->count < y->count ? 1 : -1; // largest first
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+// Build a minimal perfect hash over keys[0..n). The key strings must outlive
+// the table. Returns false on duplicates, oversize input or allocation failure.
+static inline bool ph_build(struct phash_built *pb, const char *const *keys, size_t n) {
+    memset(pb, 0, sizeof *pb);
+    if (n == 0 || n > UINT16_MAX) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (strlen(keys[i]) > 255) return false;
+        for (size_t j = 0; j < i; ++j)
+            if (strcmp(keys[i], keys[j]) == 0) return false;
+    }
+
+    uint32_t nb = (uint32_t)((n + 1) / 2); // ~2 keys per bucket
+    uint64_t *hashes = (uint64_t *)malloc(n * sizeof *hashes);
+    uint32_t *order = (uint32_t *)malloc(n * sizeof *order);      // keys grouped by bucket
+    struct ph_bucket *buckets = (struct ph_bucket *)calloc(nb, sizeof *buckets);
+    bool *taken = (bool *)calloc(n, sizeof *taken);
+    uint32_t *trial = (uint32_t *)malloc(n * sizeof *trial);
+    pb->disp = (uint32_t *)calloc(nb, sizeof *pb->disp);
+    pb->slot_names = (const char **)calloc(n, sizeof *pb->slot_names);
+    pb->slot_lens = (uint8_t *)calloc(n, sizeof *pb->slot_lens);
+    pb->slot_ids = (uint16_t *)calloc(n, sizeof *pb->slot_ids);
+    bool ok = hashes && order && buckets && taken && trial &&
+              pb->disp && pb->slot_names && pb->slot_lens && pb->slot_ids;
+
+    if (ok) {
+        for (uint32_t b = 0; b < nb; ++b) buckets[b].index = b;
+        for (size_t i = 0; i < n; ++i) {
+            hashes[i] = ph_hash64(keys[i], strlen(keys[i]));
+            buckets[ph_reduce((uint32_t)(hashes[i] >> 32), nb)].count++;
+        }
+        // Counting sort of key indices by bucket
+        uint32_t pos = 0;
+        for (uint32_t b = 0; b < nb; ++b) { buckets[b].first = pos; pos += buckets[b].count; }
+        uint32_t *fill = (uint32_t *)calloc(nb, sizeof *fill);
+        if (!fill) ok = false;
+        for (size_t i = 0; ok && i < n; ++i) {
+            uint32_t b = ph_reduce((uint32_t)(hashes[i] >> 32), nb);
+            order[buckets[b].first + fill[b]++] = (uint32_t)i;
+        }
+        free(fill);
+    }
+
+    if (ok) {
+        struct ph_bucket *sorted = (struct ph_bucket *)malloc(nb * sizeof *sorted);
+        if (!sorted) ok = false;
+        else {
+            memcpy(sorted, buckets, nb * sizeof *sorted);
+            qsort(sorted, nb, sizeof *sorted, ph_cmp_bucket);
+        }
+        for (uint32_t s = 0; ok && s < nb && sorted[s].count; ++s) {
+            const struct ph_bucket *bk = &sorted[s];
+            uint32_t d = 0;
+            for (;; ++d) {
+                if (d == UINT32_MAX) { ok = false; break; }
+                bool fits = true;
+                for (uint32_t k = 0; k < bk->count && fits; ++k) {
+                    uint64_t h = hashes[order[bk->first + k]];
+                    trial[k] = ph_reduce(ph_mix32((uint32_t)h ^ d), (uint32_t)n);
+                    if (taken[trial[k]]) fits = false;
+                    for (uint32_t j = 0; j < k && fits; ++j)
+                        if (trial[j] == trial[k]) fits = false;
+                }
+                if (fits) break;
+            }
+            if (!ok) break;
+            pb->disp[bk->index] = d;
+            for (uint32_t k = 0; k < bk->count; ++k) {
+                uint32_t id = order[bk->first + k];
+                taken[trial[k]] = true;
+                pb->slot_names[trial[k]] = keys[id];
+                pb->slot_lens[trial[k]] = (uint8_t)strlen(keys[id]);
+                pb->slot_ids[trial[k]] = (uint16_t)id;
+            }
+        }
+        free(sorted);
+    }
+
+    free(hashes); free(order); free(buckets); free(taken); free(trial);
+    if (!ok) { ph_free(pb); return false; }
+
+    pb->ph.n = (uint32_t)n;
+    pb->ph.nbuckets = nb;
+    pb->ph.disp = pb->disp;
+    pb->ph.slot_names = pb->slot_names;
+    pb->ph.slot_lens = pb->slot_lens;
+    pb->ph.slot_ids = pb->slot_ids;
+    pb->ph.names = keys;
+    return true;
+}
+
+#endif // PHASH_H
@@ -0,0 +1,43 @@
+// Generated by: build/phash gen day:Mon,Tue,Wed,Thu,Fri,Sat,Sun cmd:0,1,2,3,4,5,6 color:red,green,blue
+// Do not edit; regenerate instead.
+#ifndef PHASH_DAY_CMD_COLOR_H
+#define PHASH_DAY_CMD_COLOR_H
+
+#include "phash.h"
+
+// day: 7 keys, 4 buckets
+enum { DAY_COUNT = 7 };
+enum day_id { DAY_MON, DAY_TUE, DAY_WED, DAY_THU, DAY_FRI, DAY_SAT, DAY_SUN };
+static const char *const day_names[7] = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+static const uint32_t day_disp[4] = { 1u, 39u, 0u, 0u };
+static const char *const day_slot_names[7] = { "Sun", "Mon", "Sat", "Wed", "Tue", "Fri", "Thu" };
+static const uint8_t day_slot_lens[7] = { 3, 3, 3, 3, 3, 3, 3 };
+static const uint16_t day_slot_ids[7] = { 6, 0, 5, 2, 1, 4, 3 };
+static const struct phash day_phash = {
+    7, 4, day_disp, day_slot_names, day_slot_lens, day_slot_ids, day_names
+};
+
+// cmd: 7 keys, 4 buckets
+enum { CMD_COUNT = 7 };
+static const char *const cmd_names[7] = { "0", "1", "2", "3", "4", "5", "6" };
+static const uint32_t cmd_disp[4] = { 0u, 9u, 0u, 18u };
+static const char *const cmd_slot_names[7] = { "5", "3", "4", "1", "2", "0", "6" };
+static const uint8_t cmd_slot_lens[7] = { 1, 1, 1, 1, 1, 1, 1 };
+static const uint16_t cmd_slot_ids[7] = { 5, 3, 4, 1, 2, 0, 6 };
+static const struct phash cmd_phash = {
+    7, 4, cmd_disp, cmd_slot_names, cmd_slot_lens, cmd_slot_ids, cmd_names
+};
+
+// color: 3 keys, 2 buckets
+enum { COLOR_COUNT = 3 };
+enum color_id { COLOR_RED, COLOR_GREEN, COLOR_BLUE };
+static const char *const color_names[3] = { "red", "green", "blue" };
+static const uint32_t color_disp[2] = { 5u, 0u };
+static const char *const color_slot_names[3] = { "green", "blue", "red" };
+static const uint8_t color_slot_lens[3] = { 5, 4, 3 };
+static const uint16_t color_slot_ids[3] = { 1, 2, 0 };
+static const struct phash color_phash = {
+    3, 2, color_disp, color_slot_names, color_slot_lens, color_slot_ids, color_names
+};
+
+#endif // PHASH_DAY_CMD_COLOR_H
@@ -0,0 +1,463 @@
+// Build: g++ -std=c++20 -O2 -pthread pipeline.cpp -o build/pipeline
+// Usage: build/pipeline gen N > data.csv          write N "key,value" records
+//        build/pipeline check                     all drivers agree, incl. over-long lines
+//        build/pipeline [--threads] [file|-]      coroutine pipeline
+//        build/pipeline --baseline [file|-]       plain single loop
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Streaming pipeline: read -> split -> parse -> aggregate. Every stage is a
+// coroutine generator pulling from the one before it. Lines and records are
+// string_views into the read buffers; the only copy is the partial line at
+// the end of a buffer, moved to the front of the next one. Buffers come from
+// a fixed pool, so memory stays flat however long the input is: when all
+// buffers are in flight the reader blocks (backpressure).
+
+// ---- Generator<T> ----
+
+template <class T>
+class Generator {
+public:
+    struct promise_type {
+        const T *value = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object() { return Generator{Handle::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        // The yielded object lives in the coroutine frame until it resumes
+        std::suspend_always yield_value(const T &v) noexcept { value = std::addressof(v); return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    class iterator {
+    public:
+        explicit iterator(Handle h) : h_(h) {}
+        const T &operator*() const { return *h_.promise().value; }
+        iterator &operator++() { advance(h_); return *this; }
+        bool operator==(std::default_sentinel_t) const { return !h_ || h_.done(); }
+    private:
+        Handle h_;
+    };
+
+    explicit Generator(Handle h) : h_(h) {}
+    Generator(Generator &&o) noexcept : h_(std::exchange(o.h_, {})) {}
+    Generator(const Generator &) = delete;
+    Generator &operator=(const Generator &) = delete;
+    ~Generator() { if (h_) h_.destroy(); }
+
+    iterator begin() { advance(h_); return iterator{h_}; }
+    std::default_sentinel_t end() { return {}; }
+
+private:
+    static void advance(Handle h) {
+        h.resume();
+        if (h.promise().error) std::rethrow_exception(h.promise().error);
+    }
+    Handle h_;
+};
+
+// ---- Bounded queue between stage threads ----
+
+template <class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t cap) : cap_(cap) {}
+
+    void push(T v) {
+        std::unique_lock<std::mutex> lk(m_);
+        not_full_.wait(lk, [&] { return q_.size() < cap_; });
+        q_.push(std::move(v));
+        not_empty_.notify_one();
+    }
+
+    // Empty optional once closed and drained
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lk(m_);
+        not_empty_.wait(lk, [&] { return !q_.empty() || closed_; });
+        if (q_.empty()) return std::nullopt;
+        T v = std::move(q_.front());
+        q_.pop();
+        not_full_.notify_one();
+        return v;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lk(m_);
+        closed_ = true;
+        not_empty_.notify_all();
+    }
+
+private:
+    std::mutex m_;
+    std::condition_variable not_full_, not_empty_;
+    std::queue<T> q_;
+    size_t cap_;
+    bool closed_ = false;
+};
+
+template <class T>
+Generator<T> drain(BoundedQueue<T> &q) {
+    while (auto v = q.pop()) co_yield *v;
+}
+
+// ---- Buffers ----
+
+struct Buffer {
+    std::unique_ptr<char[]> data;
+    size_t cap;
+};
+
+// Fixed set of buffers; acquire() blocks while all of them are in flight.
+class BufferPool {
+public:
+    BufferPool(size_t count, size_t size) : free_(count) {
+        for (size_t i = 0; i < count; ++i) {
+            all_.push_back(Buffer{std::make_unique<char[]>(size), size});
+            free_.push(&all_.back());
+        }
+    }
+    Buffer *acquire() { return *free_.pop(); }
+    void release(Buffer *b) { free_.push(b); }
+
+private:
+    std::deque<Buffer> all_; // stable addresses
+    BoundedQueue<Buffer *> free_;
+};
+
+struct Chunk {
+    Buffer *buf;
+    std::string_view text; // whole lines only
+};
+
+struct Record {
+    std::string_view key;
+    int64_t value;
+};
+
+struct Stats {
+    int64_t count = 0, sum = 0, min = INT64_MAX, max = INT64_MIN;
+    bool operator==(const Stats &) const = default;
+};
+
+// Heterogeneous lookup: find() by string_view without building a string
+struct SvHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+using StatsMap = std::unordered_map<std::string, Stats, SvHash, std::equal_to<>>;
+
+// ---- Stages ----
+
+// Read fd into pooled buffers, yielding runs of complete lines. Only the
+// trailing partial line is copied, into the front of the next buffer. A line
+// that does not fit in a buffer is skipped up to its '\n' and counted in
+// overlong (every driver treats it as one bad record).
+Generator<Chunk> read_stage(int fd, BufferPool &pool, size_t &overlong) {
+    const char *carry = nullptr;
+    size_t carry_len = 0;
+    bool skipping = false;
+    for (;;) {
+        Buffer *b = pool.acquire();
+        if (carry_len) std::memmove(b->data.get(), carry, carry_len);
+        size_t len = carry_len;
+        bool eof = false;
+        while (len < b->cap) {
+            ssize_t n = read(fd, b->data.get() + len, b->cap - len);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) { std::perror("read"); eof = true; break; }
+            if (n == 0) { eof = true; break; }
+            len += (size_t)n;
+            if (std::memchr(b->data.get() + len - n, '\n', (size_t)n)) break; // have a line: go
+        }
+        const char *data = b->data.get();
+        size_t start = 0;
+        if (skipping) { // carry_len is 0 here
+            const char *nl = static_cast<const char *>(std::memchr(data, '\n', len));
+            start = nl ? (size_t)(nl - data) + 1 : len;
+            skipping = !nl;
+        }
+        std::string_view all(data + start, len - start);
+        size_t cut = eof ? all.size() : all.rfind('\n') + 1; // npos + 1 == 0
+        if (cut == 0) { // no complete line in this buffer
+            pool.release(b);
+            if (eof) co_return;
+            if (start == 0 && len == b->cap) {
+                ++overlong;
+                skipping = true;
+                carry_len = 0;
+            } else {
+                carry = all.data();
+                carry_len = all.size();
+            }
+            continue;
+        }
+        carry = all.data() + cut;
+        carry_len = all.size() - cut;
+        co_yield Chunk{b, all.substr(0, cut)};
+        if (eof) co_return;
+    }
+}
+
+Generator<std::string_view> split_stage(std::string_view text) {
+    while (!text.empty()) {
+        size_t nl = text.find('\n');
+        std::string_view line = text.substr(0, nl);
+        text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (!line.empty()) co_yield line;
+    }
+}
+
+static bool parse_record(std::string_view line, Record &r) {
+    size_t comma = line.find(',');
+    if (comma == std::string_view::npos || comma == 0) return false;
+    const char *first = line.data() + comma + 1, *last = line.data() + line.size();
+    auto [ptr, ec] = std::from_chars(first, last, r.value);
+    if (ec != std::errc() || ptr != last) return false;
+    r.key = line.substr(0, comma);
+    return true;
+}
+
+Generator<Record> parse_stage(Generator<std::string_view> lines, size_t &bad) {
+    Record r;
+    for (std::string_view line : lines) {
+        if (parse_record(line, r)) co_yield r;
+        else ++bad;
+    }
+}
+
+static void aggregate(StatsMap &m, const Record &r) {
+    auto it = m.find(r.key);
+    if (it == m.end()) it = m.emplace(std::string(r.key), Stats{}).first;
+    Stats &s = it->second;
+    s.count++;
+    s.sum += r.value;
+    if (r.value < s.min) s.min = r.value;
+    if (r.value > s.max) s.max = r.value;
+}
+
+// ---- Drivers ----
+
+struct Result {
+    StatsMap stats;
+    size_t records = 0, bad = 0;
+};
+
+constexpr size_t kBufSize = 1 << 20;
+constexpr size_t kBuffers = 4;
+
+// All stages on one thread, pulled lazily from the aggregate loop
+static void run_inline(int fd, Result &res) {
+    BufferPool pool(2, kBufSize);
+    size_t overlong = 0;
+    for (const Chunk &c : read_stage(fd, pool, overlong)) {
+        for (const Record &r : parse_stage(split_stage(c.text), res.bad)) {
+            aggregate(res.stats, r);
+            res.records++;
+        }
+        pool.release(c.buf);
+    }
+    res.bad += overlong;
+}
+
+struct Batch {
+    Buffer *buf;
+    std::vector<Record> records;
+};
+
+// reader thread -> chunks -> parser thread -> batches -> aggregator (caller)
+static void run_threaded(int fd, Result &res) {
+    BufferPool pool(kBuffers, kBufSize);
+    BoundedQueue<Chunk> chunks(kBuffers);
+    BoundedQueue<Batch> batches(kBuffers);
+    size_t bad = 0, overlong = 0;
+
+    std::thread reader([&] {
+        for (const Chunk &c : read_stage(fd, pool, overlong)) chunks.push(c);
+        chunks.close();
+    });
+    std::thread parser([&] {
+        for (const Chunk &c : drain(chunks)) {
+            Batch b{c.buf, {}};
+            b.records.reserve(c.text.size() / 16);
+            for (const Record &r : parse_stage(split_stage(c.text), bad)) b.records.push_back(r);
+            batches.push(std::move(b));
+        }
+        batches.close();
+    });
+    for (const Batch &b : drain(batches)) {
+        for (const Record &r : b.records) aggregate(res.stats, r);
+        res.records += b.records.size();
+        pool.release(b.buf); // last user of these bytes
+    }
+    reader.join();
+    parser.join();
+    res.bad = bad + overlong;
+}
+
+// Reference: one loop, no stages, same buffer handling and parsing
+static void run_baseline(int fd, Result &res) {
+    std::vector<char> buf(kBufSize);
+    size_t have = 0;
+    bool skipping = false; // inside an over-long line
+    for (;;) {
+        ssize_t n = read(fd, buf.data() + have, buf.size() - have);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) { std::perror("read"); break; }
+        bool eof = n == 0;
+        have += (size_t)n;
+        size_t start = 0;
+        if (skipping) {
+            const char *nl = static_cast<const char *>(std::memchr(buf.data(), '\n', have));
+            if (!nl) { have = 0; if (eof) break; continue; }
+            start = (size_t)(nl - buf.data()) + 1;
+            skipping = false;
+        }
+        for (size_t i = start; i < have; ++i) {
+            if (buf[i] != '\n' && !(eof && i + 1 == have)) continue;
+            size_t end = buf[i] == '\n' ? i : i + 1;
+            std::string_view line(buf.data() + start, end - start);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            Record r;
+            if (!line.empty()) {
+                if (parse_record(line, r)) { aggregate(res.stats, r); res.records++; }
+                else res.bad++;
+            }
+            start = i + 1;
+        }
+        if (eof) break;
+        std::memmove(buf.data(), buf.data() + start, have - start);
+        have -= start;
+        if (have == buf.size()) { // over-long line: drop it, like read_stage
+            res.bad++;
+            skipping = true;
+            have = 0;
+        }
+    }
+}
+
+static double now_sec() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int generate(FILE *f, unsigned long long n) {
+    std::vector<char> out;
+    out.reserve(1 << 20);
+    uint64_t x = 88172645463325252ull;
+    char line[64];
+    for (unsigned long long i = 0; i < n; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        int len = std::snprintf(line, sizeof line, "user%llu,%lld\n",
+                                (unsigned long long)(x % 1000), (long long)(x >> 40) - 8000000);
+        out.insert(out.end(), line, line + len);
+        if (out.size() > (1 << 20) - 64) {
+            if (std::fwrite(out.data(), 1, out.size(), f) != out.size()) return 1;
+            out.clear();
+        }
+    }
+    return std::fwrite(out.data(), 1, out.size(), f) == out.size() ? 0 : 1;
+}
+
+// Generated records mixed with lines around the buffer size: kBufSize bytes
+// with the '\n' fit, one more does not and is dropped as one bad record, in
+// every driver. The input also ends inside an over-long line.
+static int check() {
+    char path[] = "/tmp/pipeline_check_XXXXXX";
+    int wfd = mkstemp(path);
+    FILE *f = wfd < 0 ? nullptr : fdopen(wfd, "w");
+    if (!f) { std::perror("mkstemp"); return 1; }
+    std::string fits(kBufSize - 3, 'k'), overlong = "user1," + std::string(2 * kBufSize + 123, '7');
+    fits += ",1";
+    bool wrote = generate(f, 200000) == 0 && std::fprintf(f, "%s\n%sk\n", overlong.c_str(), fits.c_str()) > 0 &&
+                 generate(f, 100000) == 0 && std::fprintf(f, "%s\nuser2,5\n%s", fits.c_str(), overlong.c_str()) > 0;
+    if (std::fclose(f) != 0 || !wrote) { std::perror("write"); unlink(path); return 1; }
+
+    const char *names[] = {"coroutines", "coroutines+threads", "baseline loop"};
+    Result res[3];
+    bool ok = true;
+    for (int m = 0; m < 3; ++m) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) { std::perror("open"); ok = false; break; }
+        if (m == 0) run_inline(fd, res[m]);
+        else if (m == 1) run_threaded(fd, res[m]);
+        else run_baseline(fd, res[m]);
+        close(fd);
+        bool same = res[m].records == 300002 && res[m].bad == 3 && res[m].stats == res[0].stats;
+        std::printf("%-20s records: %zu (bad %zu), keys: %zu %s\n", names[m], res[m].records, res[m].bad,
+                    res[m].stats.size(), same ? "ok" : "MISMATCH");
+        ok &= same;
+    }
+    unlink(path);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2 && std::strcmp(argv[1], "gen") == 0) return generate(stdout, std::strtoull(argv[2], nullptr, 10));
+    if (argc > 1 && std::strcmp(argv[1], "check") == 0) return check();
+
+    enum { INLINE, THREADED, BASELINE } mode = INLINE;
+    const char *path = "-";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0) mode = THREADED;
+        else if (std::strcmp(argv[i], "--baseline") == 0) mode = BASELINE;
+        else path = argv[i];
+    }
+    int fd = std::strcmp(path, "-") == 0 ? 0 : open(path, O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "open failed: %s (errno=%d)\n", std::strerror(errno), errno);
+        return 1;
+    }
+
+    Result res;
+    double t0 = now_sec();
+    try {
+        if (mode == THREADED) run_threaded(fd, res);
+        else if (mode == BASELINE) run_baseline(fd, res);
+        else run_inline(fd, res);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "pipeline error: %s\n", e.what());
+        return 1;
+    }
+    double dt = now_sec() - t0;
+    if (fd != 0) close(fd);
+
+    int64_t total = 0;
+    for (const auto &kv : res.stats) total += kv.second.sum;
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    const char *names[] = {"coroutines", "coroutines+threads", "baseline loop"};
+    std::printf("-- Pipeline (%s) --\n", names[mode]);
+    std::printf("records: %zu (bad %zu), keys: %zu, sum: %lld\n",
+                res.records, res.bad, res.stats.size(), (long long)total);
+    std::printf("time: %.3f s, %.2f M records/s, peak RSS: %ld KiB\n",
+                dt, (double)res.records / dt / 1e6, ru.ru_maxrss);
+    return 0;
+}
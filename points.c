@@ -0,0 +1,505 @@
+// Build: gcc -O2 -pthread points.c -o build/points
+// Usage: build/points [threads]
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "cpuprobe.h"
+#include "tpool.h"
+
+// Same layout as memptr.c
+struct Point { int x, y; };
+
+static void move_point(struct Point *p, int dx, int dy) {
+    if (!p) return;
+    p->x += dx;
+    p->y += dy;
+}
+
+// Structure-of-arrays point collection: x and y live in separate 64-byte
+// aligned arrays so batched operations stream through memory and map
+// directly onto SIMD lanes. Capacity is kept a multiple of 16 elements.
+struct point_buf {
+    int32_t *x, *y;
+    size_t len, cap;
+};
+
+struct bbox { int32_t minx, miny, maxx, maxy; }; // empty when minx > maxx
+
+#define PB_ALIGN 64
+
+static void pb_init(struct point_buf *pb) { memset(pb, 0, sizeof *pb); }
+
+static void pb_free(struct point_buf *pb) {
+    free(pb->x);
+    free(pb->y);
+    pb_init(pb);
+}
+
+static bool pb_reserve(struct point_buf *pb, size_t n) {
+    if (n <= pb->cap) return true;
+    size_t cap = pb->cap ? pb->cap * 2 : 64;
+    if (cap < n) cap = n;
+    cap = (cap + 15) & ~(size_t)15;
+    int32_t *x = aligned_alloc(PB_ALIGN, cap * sizeof *x);
+    int32_t *y = aligned_alloc(PB_ALIGN, cap * sizeof *y);
+    if (!x || !y) { free(x); free(y); return false; }
+    if (pb->len) {
+        memcpy(x, pb->x, pb->len * sizeof *x);
+        memcpy(y, pb->y, pb->len * sizeof *y);
+    }
+    free(pb->x);
+    free(pb->y);
+    pb->x = x;
+    pb->y = y;
+    pb->cap = cap;
+    return true;
+}
+
+static bool pb_push(struct point_buf *pb, struct Point p) {
+    if (pb->len == pb->cap && !pb_reserve(pb, pb->len + 1)) return false;
+    pb->x[pb->len] = p.x;
+    pb->y[pb->len] = p.y;
+    pb->len++;
+    return true;
+}
+
+static struct Point pb_get(const struct point_buf *pb, size_t i) {
+    struct Point p = { pb->x[i], pb->y[i] };
+    return p;
+}
+
+// AoS -> SoA (replaces the contents)
+static bool pb_from_aos(struct point_buf *pb, const struct Point *pts, size_t n) {
+    if (!pb_reserve(pb, n)) return false;
+    for (size_t i = 0; i < n; ++i) { pb->x[i] = pts[i].x; pb->y[i] = pts[i].y; }
+    pb->len = n;
+    return true;
+}
+
+// SoA -> AoS; out must hold pb->len points
+static void pb_to_aos(const struct point_buf *pb, struct Point *out) {
+    for (size_t i = 0; i < pb->len; ++i) { out[i].x = pb->x[i]; out[i].y = pb->y[i]; }
+}
+
+// ---- Kernels: scalar reference ----
+// Arithmetic wraps like the SIMD variants (done in unsigned to avoid UB).
+
+static void translate_scalar(int32_t *x, int32_t *y, size_t n, int32_t dx, int32_t dy) {
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = (int32_t)((uint32_t)x[i] + (uint32_t)dx);
+        y[i] = (int32_t)((uint32_t)y[i] + (uint32_t)dy);
+    }
+}
+
+static void scale_scalar(int32_t *x, int32_t *y, size_t n, int32_t sx, int32_t sy) {
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = (int32_t)((uint32_t)x[i] * (uint32_t)sx);
+        y[i] = (int32_t)((uint32_t)y[i] * (uint32_t)sy);
+    }
+}
+
+static struct bbox bbox_scalar(const int32_t *x, const int32_t *y, size_t n) {
+    struct bbox b = { INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+    for (size_t i = 0; i < n; ++i) {
+        if (x[i] < b.minx) b.minx = x[i];
+        if (x[i] > b.maxx) b.maxx = x[i];
+        if (y[i] < b.miny) b.miny = y[i];
+        if (y[i] > b.maxy) b.maxy = y[i];
+    }
+    return b;
+}
+
+// Keep points inside r (inclusive), compacting in place; returns the new count.
+static size_t filter_scalar(int32_t *x, int32_t *y, size_t n, struct bbox r) {
+    size_t out = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int32_t px = x[i], py = y[i];
+        x[out] = px;
+        y[out] = py;
+        out += (px >= r.minx) & (px <= r.maxx) & (py >= r.miny) & (py <= r.maxy);
+    }
+    return out;
+}
+
+// ---- Kernels: AVX2 / AVX-512 ----
+#ifdef CPU_X86
+
+CPU_TARGET_AVX2
+static void translate_avx2(int32_t *x, int32_t *y, size_t n, int32_t dx, int32_t dy) {
+    __m256i vdx = _mm256_set1_epi32(dx), vdy = _mm256_set1_epi32(dy);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i vx = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i *)(y + i));
+        _mm256_storeu_si256((__m256i *)(x + i), _mm256_add_epi32(vx, vdx));
+        _mm256_storeu_si256((__m256i *)(y + i), _mm256_add_epi32(vy, vdy));
+    }
+    translate_scalar(x + i, y + i, n - i, dx, dy);
+}
+
+CPU_TARGET_AVX2
+static void scale_avx2(int32_t *x, int32_t *y, size_t n, int32_t sx, int32_t sy) {
+    __m256i vsx = _mm256_set1_epi32(sx), vsy = _mm256_set1_epi32(sy);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i vx = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i *)(y + i));
+        _mm256_storeu_si256((__m256i *)(x + i), _mm256_mullo_epi32(vx, vsx));
+        _mm256_storeu_si256((__m256i *)(y + i), _mm256_mullo_epi32(vy, vsy));
+    }
+    scale_scalar(x + i, y + i, n - i, sx, sy);
+}
+
+CPU_TARGET_AVX2
+static struct bbox bbox_avx2(const int32_t *x, const int32_t *y, size_t n) {
+    __m256i mnx = _mm256_set1_epi32(INT32_MAX), mny = mnx;
+    __m256i mxx = _mm256_set1_epi32(INT32_MIN), mxy = mxx;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i vx = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i *)(y + i));
+        mnx = _mm256_min_epi32(mnx, vx); mxx = _mm256_max_epi32(mxx, vx);
+        mny = _mm256_min_epi32(mny, vy); mxy = _mm256_max_epi32(mxy, vy);
+    }
+    int32_t a[8], b[8], c[8], d[8];
+    _mm256_storeu_si256((__m256i *)a, mnx); _mm256_storeu_si256((__m256i *)b, mny);
+    _mm256_storeu_si256((__m256i *)c, mxx); _mm256_storeu_si256((__m256i *)d, mxy);
+    struct bbox r = bbox_scalar(x + i, y + i, n - i);
+    for (int k = 0; k < 8; ++k) {
+        if (a[k] < r.minx) r.minx = a[k];
+        if (b[k] < r.miny) r.miny = b[k];
+        if (c[k] > r.maxx) r.maxx = c[k];
+        if (d[k] > r.maxy) r.maxy = d[k];
+    }
+    return r;
+}
+
+// Lane permutation for each 8-bit keep mask: selected lanes first.
+static int32_t filter_lut[256][8];
+
+static void filter_lut_init(void) {
+    for (int m = 0; m < 256; ++m) {
+        int k = 0;
+        for (int lane = 0; lane < 8; ++lane) if (m & (1 << lane)) filter_lut[m][k++] = lane;
+        while (k < 8) filter_lut[m][k++] = 0;
+    }
+}
+
+CPU_TARGET_AVX2
+static size_t filter_avx2(int32_t *x, int32_t *y, size_t n, struct bbox r) {
+    __m256i lox = _mm256_set1_epi32(r.minx), hix = _mm256_set1_epi32(r.maxx);
+    __m256i loy = _mm256_set1_epi32(r.miny), hiy = _mm256_set1_epi32(r.maxy);
+    size_t out = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i vx = _mm256_loadu_si256((const __m256i *)(x + i));
+        __m256i vy = _mm256_loadu_si256((const __m256i *)(y + i));
+        __m256i outside = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpgt_epi32(lox, vx), _mm256_cmpgt_epi32(vx, hix)),
+            _mm256_or_si256(_mm256_cmpgt_epi32(loy, vy), _mm256_cmpgt_epi32(vy, hiy)));
+        unsigned keep = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+        __m256i perm = _mm256_loadu_si256((const __m256i *)filter_lut[keep]);
+        // out <= i, so the full-width stores never pass data not yet loaded
+        _mm256_storeu_si256((__m256i *)(x + out), _mm256_permutevar8x32_epi32(vx, perm));
+        _mm256_storeu_si256((__m256i *)(y + out), _mm256_permutevar8x32_epi32(vy, perm));
+        out += (size_t)__builtin_popcount(keep);
+    }
+    for (; i < n; ++i) {
+        int32_t px = x[i], py = y[i];
+        x[out] = px;
+        y[out] = py;
+        out += (px >= r.minx) & (px <= r.maxx) & (py >= r.miny) & (py <= r.maxy);
+    }
+    return out;
+}
+
+CPU_TARGET_AVX512
+static size_t filter_avx512(int32_t *x, int32_t *y, size_t n, struct bbox r) {
+    __m512i lox = _mm512_set1_epi32(r.minx), hix = _mm512_set1_epi32(r.maxx);
+    __m512i loy = _mm512_set1_epi32(r.miny), hiy = _mm512_set1_epi32(r.maxy);
+    size_t out = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i vx = _mm512_loadu_si512((const void *)(x + i));
+        __m512i vy = _mm512_loadu_si512((const void *)(y + i));
+        __mmask16 keep = _mm512_cmpge_epi32_mask(vx, lox) & _mm512_cmple_epi32_mask(vx, hix) &
+                         _mm512_cmpge_epi32_mask(vy, loy) & _mm512_cmple_epi32_mask(vy, hiy);
+        _mm512_mask_compressstoreu_epi32(x + out, keep, vx);
+        _mm512_mask_compressstoreu_epi32(y + out, keep, vy);
+        out += (size_t)__builtin_popcount(keep);
+    }
+    for (; i < n; ++i) {
+        int32_t px = x[i], py = y[i];
+        x[out] = px;
+        y[out] = py;
+        out += (px >= r.minx) & (px <= r.maxx) & (py >= r.miny) & (py <= r.maxy);
+    }
+    return out;
+}
+#endif
+
+// ---- Dispatch, resolved once ----
+
+typedef void (*pt_map_fn)(int32_t *, int32_t *, size_t, int32_t, int32_t);
+typedef struct bbox (*pt_bbox_fn)(const int32_t *, const int32_t *, size_t);
+typedef size_t (*pt_filter_fn)(int32_t *, int32_t *, size_t, struct bbox);
+
+static const pt_map_fn translate_table[CPU_LEVEL_COUNT] = {
+    [CPU_LEVEL_SCALAR] = translate_scalar,
+#ifdef CPU_X86
+    [CPU_LEVEL_AVX2] = translate_avx2,
+#endif
+};
+static const pt_map_fn scale_table[CPU_LEVEL_COUNT] = {
+    [CPU_LEVEL_SCALAR] = scale_scalar,
+#ifdef CPU_X86
+    [CPU_LEVEL_AVX2] = scale_avx2,
+#endif
+};
+static const pt_bbox_fn bbox_table[CPU_LEVEL_COUNT] = {
+    [CPU_LEVEL_SCALAR] = bbox_scalar,
+#ifdef CPU_X86
+    [CPU_LEVEL_AVX2] = bbox_avx2,
+#endif
+};
+static const pt_filter_fn filter_table[CPU_LEVEL_COUNT] = {
+    [CPU_LEVEL_SCALAR] = filter_scalar,
+#ifdef CPU_X86
+    [CPU_LEVEL_AVX2] = filter_avx2,
+    [CPU_LEVEL_AVX512] = filter_avx512,
+#endif
+};
+
+static pt_map_fn pt_translate, pt_scale;
+static pt_bbox_fn pt_bbox;
+static pt_filter_fn pt_filter;
+
+static void pb_kernels_init(void) {
+#ifdef CPU_X86
+    filter_lut_init();
+#endif
+    CPU_DISPATCH(pt_translate, translate_table);
+    CPU_DISPATCH(pt_scale, scale_table);
+    CPU_DISPATCH(pt_bbox, bbox_table);
+    CPU_DISPATCH(pt_filter, filter_table);
+}
+
+// ---- Batched operations; pool may be NULL for single-threaded ----
+
+#define PB_GRAIN 65536 // points per parallel chunk (multiple of 16)
+
+struct pb_par { struct point_buf *pb; pt_map_fn fn; int32_t a, b; struct bbox r; struct bbox *parts; size_t *kept; };
+
+static void pb_map_body(size_t lo, size_t hi, void *p) {
+    struct pb_par *c = p;
+    c->fn(c->pb->x + lo, c->pb->y + lo, hi - lo, c->a, c->b);
+}
+
+static void pb_map(struct tp_pool *pool, struct point_buf *pb, pt_map_fn fn, int32_t a, int32_t b) {
+    if (!pool || pb->len <= PB_GRAIN) { fn(pb->x, pb->y, pb->len, a, b); return; }
+    struct pb_par c = { pb, fn, a, b, { 0, 0, 0, 0 }, NULL, NULL };
+    tp_parallel_for(pool, 0, pb->len, PB_GRAIN, pb_map_body, &c);
+}
+
+static void pb_translate(struct tp_pool *pool, struct point_buf *pb, int32_t dx, int32_t dy) {
+    pb_map(pool, pb, pt_translate, dx, dy);
+}
+
+static void pb_scale(struct tp_pool *pool, struct point_buf *pb, int32_t sx, int32_t sy) {
+    pb_map(pool, pb, pt_scale, sx, sy);
+}
+
+static void bbox_merge(struct bbox *acc, const struct bbox *o) {
+    if (o->minx < acc->minx) acc->minx = o->minx;
+    if (o->miny < acc->miny) acc->miny = o->miny;
+    if (o->maxx > acc->maxx) acc->maxx = o->maxx;
+    if (o->maxy > acc->maxy) acc->maxy = o->maxy;
+}
+
+static void pb_bbox_map(size_t lo, size_t hi, void *acc, void *p) {
+    struct pb_par *c = p;
+    struct bbox b = pt_bbox(c->pb->x + lo, c->pb->y + lo, hi - lo);
+    bbox_merge(acc, &b);
+}
+
+static void pb_bbox_combine(void *acc, const void *other, void *p) {
+    (void)p;
+    bbox_merge(acc, other);
+}
+
+static struct bbox pb_bounds(struct tp_pool *pool, const struct point_buf *pb) {
+    if (!pool || pb->len <= PB_GRAIN) return pt_bbox(pb->x, pb->y, pb->len);
+    struct bbox r = { INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+    struct pb_par c = { (struct point_buf *)pb, NULL, 0, 0, r, NULL, NULL };
+    if (!tp_parallel_reduce(pool, 0, pb->len, PB_GRAIN, &r, sizeof r, pb_bbox_map, pb_bbox_combine, &c))
+        return pt_bbox(pb->x, pb->y, pb->len);
+    return r;
+}
+
+static void pb_filter_body(size_t lo, size_t hi, void *p) {
+    struct pb_par *c = p;
+    for (size_t k = lo; k < hi; ++k) {
+        size_t a = k * PB_GRAIN, b = a + PB_GRAIN < c->pb->len ? a + PB_GRAIN : c->pb->len;
+        c->kept[k] = pt_filter(c->pb->x + a, c->pb->y + a, b - a, c->r);
+    }
+}
+
+// Keep points inside r. In parallel each chunk compacts in place, then the
+// chunk results are slid down in order, so the original order is preserved.
+static void pb_filter(struct tp_pool *pool, struct point_buf *pb, struct bbox r) {
+    size_t chunks = (pb->len + PB_GRAIN - 1) / PB_GRAIN;
+    size_t *kept = pool && chunks > 1 ? malloc(chunks * sizeof *kept) : NULL;
+    if (!kept) { pb->len = pt_filter(pb->x, pb->y, pb->len, r); return; }
+    struct pb_par c = { pb, NULL, 0, 0, r, NULL, kept };
+    tp_parallel_for(pool, 0, chunks, 1, pb_filter_body, &c);
+    size_t out = kept[0];
+    for (size_t k = 1; k < chunks; ++k) {
+        memmove(pb->x + out, pb->x + k * PB_GRAIN, kept[k] * sizeof *pb->x);
+        memmove(pb->y + out, pb->y + k * PB_GRAIN, kept[k] * sizeof *pb->y);
+        out += kept[k];
+    }
+    pb->len = out;
+    free(kept);
+}
+
+// ---- Demo ----
+
+static void soa_demo(struct tp_pool *pool) {
+    struct Point pts[] = { {1, 2}, {-5, 7}, {10, -3}, {4, 4} };
+    size_t n = sizeof pts / sizeof pts[0];
+    struct point_buf pb;
+    pb_init(&pb);
+    if (!pb_from_aos(&pb, pts, n)) { perror("pb_from_aos"); return; }
+    pb_push(&pb, (struct Point){ 0, 0 });
+
+    pb_translate(pool, &pb, 3, -1); // move_point(&pt, 3, -1) for every point
+    pb_scale(pool, &pb, 2, 2);
+    struct bbox b = pb_bounds(pool, &pb);
+    printf("bbox after translate+scale: (%d,%d)-(%d,%d)\n", b.minx, b.miny, b.maxx, b.maxy);
+
+    struct bbox keep = { 0, 0, 20, 20 };
+    pb_filter(pool, &pb, keep);
+    struct Point back[8];
+    pb_to_aos(&pb, back);
+    printf("inside (0,0)-(20,20):");
+    for (size_t i = 0; i < pb.len; ++i) printf(" (%d,%d)", back[i].x, back[i].y);
+    struct Point first = pb_get(&pb, 0);
+    printf("\nfirst as struct Point: (%d, %d)\n", first.x, first.y);
+    pb_free(&pb);
+}
+
+// ---- Benchmark: AoS move_point vs SoA batches ----
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+__attribute__((noinline))
+static void aos_move_all(struct Point *pts, size_t n, int dx, int dy) {
+    for (size_t i = 0; i < n; ++i) move_point(&pts[i], dx, dy);
+}
+
+static struct bbox aos_bbox(const struct Point *pts, size_t n) {
+    struct bbox b = { INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+    for (size_t i = 0; i < n; ++i) {
+        if (pts[i].x < b.minx) b.minx = pts[i].x;
+        if (pts[i].x > b.maxx) b.maxx = pts[i].x;
+        if (pts[i].y < b.miny) b.miny = pts[i].y;
+        if (pts[i].y > b.maxy) b.maxy = pts[i].y;
+    }
+    return b;
+}
+
+static void bench(struct tp_pool *pool) {
+    size_t n = (size_t)1 << 23;
+    struct Point *aos = malloc(n * sizeof *aos);
+    struct point_buf pb;
+    pb_init(&pb);
+    if (!aos || !pb_reserve(&pb, n)) { perror("malloc"); free(aos); pb_free(&pb); return; }
+    uint32_t s = 1;
+    for (size_t i = 0; i < n; ++i) {
+        s = s * 1664525u + 1013904223u;
+        aos[i].x = (int)(s >> 20) - 2048;
+        aos[i].y = (int)((s >> 8) & 0xFFF) - 2048;
+    }
+    pb_from_aos(&pb, aos, n);
+    int reps = 10;
+    double mp = (double)n * reps / 1e6;
+
+    double t0 = now_sec();
+    for (int r = 0; r < reps; ++r) aos_move_all(aos, n, 1, -1);
+    double t_aos = now_sec() - t0;
+
+    pt_map_fn tr_scalar = translate_scalar;
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r) tr_scalar(pb.x, pb.y, pb.len, 1, -1);
+    double t_soa_scalar = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r) pb_translate(NULL, &pb, 1, -1);
+    double t_soa = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r) pb_translate(pool, &pb, 1, -1);
+    double t_soa_par = now_sec() - t0;
+
+    // SoA went through three translate runs, AoS through one: catch AoS up
+    aos_move_all(aos, n, 2 * reps, -2 * reps);
+    struct bbox ba = aos_bbox(aos, n);
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r) ba = aos_bbox(aos, n);
+    double t_aos_bb = now_sec() - t0;
+    struct bbox bs = pb_bounds(NULL, &pb);
+    t0 = now_sec();
+    for (int r = 0; r < reps; ++r) bs = pb_bounds(NULL, &pb);
+    double t_soa_bb = now_sec() - t0;
+    struct bbox bp = pb_bounds(pool, &pb);
+    bool ok = memcmp(&ba, &bs, sizeof ba) == 0 && memcmp(&bs, &bp, sizeof bs) == 0;
+
+    printf("%zu points, kernels: %s, threads: %u\n", n, cpu_level_name(cpu_info()->level), tp_size(pool));
+    printf("translate AoS move_point: %8.1f Mpts/s\n", mp / t_aos);
+    printf("translate SoA scalar:     %8.1f Mpts/s\n", mp / t_soa_scalar);
+    printf("translate SoA SIMD:       %8.1f Mpts/s\n", mp / t_soa);
+    printf("translate SoA parallel:   %8.1f Mpts/s\n", mp / t_soa_par);
+    printf("bbox AoS:                 %8.1f Mpts/s\n", mp / t_aos_bb);
+    printf("bbox SoA SIMD:            %8.1f Mpts/s %s\n", mp / t_soa_bb, ok ? "ok" : "MISMATCH");
+
+    struct bbox keep = { -1000, -1000, 1000, 1000 };
+    struct point_buf ref;
+    pb_init(&ref);
+    pb_from_aos(&ref, aos, n);
+    t0 = now_sec();
+    pb_filter(pool, &pb, keep);
+    double t_f = now_sec() - t0;
+    ref.len = filter_scalar(ref.x, ref.y, ref.len, keep);
+    ok = ref.len == pb.len && memcmp(ref.x, pb.x, pb.len * sizeof *pb.x) == 0 &&
+         memcmp(ref.y, pb.y, pb.len * sizeof *pb.y) == 0;
+    printf("filter SoA:               %8.1f Mpts/s, kept %zu %s\n", (double)n / 1e6 / t_f, pb.len, ok ? "ok" : "MISMATCH");
+
+    pb_free(&ref);
+    pb_free(&pb);
+    free(aos);
+}
+
+int main(int argc, char **argv) {
+    pb_kernels_init();
+    unsigned threads = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : 0;
+    struct tp_pool *pool = tp_create(threads);
+    if (!pool) { fprintf(stderr, "tp_create failed\n"); return 1; }
+
+    puts("-- SoA Point Buffer --");
+    soa_demo(pool);
+
+    puts("\n-- Benchmark: AoS vs SoA --");
+    bench(pool);
+
+    tp_destroy(pool);
+    return 0;
+}
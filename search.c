@@ -0,0 +1,216 @@
+// Build: gcc -O2 search.c -o build/search
+// Usage: build/search [MB] [patterns]   (haystack size, keyword count; default 64, 5000)
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "search.h"
+
+#define LEN(x) (sizeof(x)/sizeof((x)[0]))
+
+// ---- Demos ----
+
+static bool print_cb(uint32_t pattern, uint64_t pos, void *ctx) {
+    const char *const *names = ctx;
+    printf(" %s@%llu", names[pattern], (unsigned long long)pos);
+    return true;
+}
+
+static void basics_demo(void) {
+    const char *text = "ushers say she sells his shells by the seashore";
+    size_t n = strlen(text);
+    printf("text: '%s'\n", text);
+    printf("ss_find(\"she\") = %llu, ss_count(\"s\") = %llu, ss_find(\"shore!\") = %s\n",
+           (unsigned long long)ss_find(text, n, "she", 3), (unsigned long long)ss_count(text, n, "s", 1),
+           ss_find(text, n, "shore!", 6) == SR_NONE ? "none" : "?");
+
+    const char *kw[] = {"he", "she", "his", "hers", "sea", "shore"};
+    struct ac ac;
+    if (!ac_build(&ac, kw, NULL, LEN(kw))) { perror("ac_build"); return; }
+    printf("aho-corasick: %u states x %u byte classes (%zu bytes)\n", ac.nstates, ac.nclasses, ac_bytes(&ac));
+    printf("all matches:");
+    ac_each(&ac, text, n, print_cb, (void *)kw);
+    uint32_t p;
+    uint64_t pos;
+    if (ac_find(&ac, text, n, &p, &pos)) printf("\nfirst: %s@%llu, ", kw[p], (unsigned long long)pos);
+    printf("count: %llu\n", (unsigned long long)ac_count(&ac, text, n));
+
+    // The same text in 5-byte chunks: matches across borders still appear once
+    struct ac_stream st;
+    ac_stream_init(&ac, &st);
+    printf("streamed:   ");
+    for (size_t i = 0; i < n; i += 5) ac_stream_feed(&ac, &st, text + i, n - i < 5 ? n - i : 5, print_cb, (void *)kw);
+    putchar('\n');
+    ac_free(&ac);
+}
+
+// ---- Benchmark ----
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t rng_state = 0xda942042e4dd58b5ull;
+static uint64_t rng(void) {
+    uint64_t x = rng_state;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return rng_state = x;
+}
+
+// Pseudo-words over a skewed alphabet, so short keywords hit often and long ones rarely.
+static void gen_word(char *w, size_t len) {
+    static const char letters[] = "etaoinshrdlcumwfgypbvkjxqz";
+    for (size_t i = 0; i < len; ++i) {
+        uint64_t r = rng();
+        w[i] = letters[(r % 26) * (r >> 32 & 0xff) / 256]; // product of uniforms: early letters dominate
+    }
+    w[len] = '\0';
+}
+
+static char *gen_text(size_t n) {
+    char *t = malloc(n + 1);
+    if (!t) return NULL;
+    size_t o = 0;
+    while (o < n) {
+        char w[16];
+        size_t len = 2 + (size_t)(rng() % 9);
+        gen_word(w, len);
+        for (size_t i = 0; i < len && o < n; ++i) t[o++] = w[i];
+        if (o < n) t[o++] = (rng() % 12) ? ' ' : '\n';
+    }
+    t[n] = '\0';
+    return t;
+}
+
+struct count_chunks { uint64_t count; };
+static bool chunk_count_cb(uint32_t pattern, uint64_t pos, void *ctx) {
+    (void)pattern; (void)pos;
+    ((struct count_chunks *)ctx)->count++;
+    return true;
+}
+
+static void bench_single(const char *text, size_t n) {
+    static const char *needles[] = {"the", "shoes", "ratio", "nastiest", "notinthetext!"};
+    printf("%-14s %10s %10s %10s %10s %10s  GB/s (count all occurrences)\n",
+           "needle", "matches", "strstr", "memmem", "ss scalar", "ss avx2");
+    for (size_t k = 0; k < LEN(needles); ++k) {
+        const char *nd = needles[k];
+        size_t m = strlen(nd);
+        double t0 = now_sec();
+        uint64_t c_strstr = 0;
+        for (const char *p = text; (p = strstr(p, nd)); ++p) ++c_strstr;
+        double t_strstr = now_sec() - t0;
+
+        t0 = now_sec();
+        uint64_t c_memmem = 0;
+        for (const char *p = text, *end = text + n; (p = memmem(p, (size_t)(end - p), nd, m)); ++p) ++c_memmem;
+        double t_memmem = now_sec() - t0;
+
+        uint64_t c_scalar = 0, c_avx2 = 0;
+        t0 = now_sec();
+        ss_scan_scalar((const uint8_t *)text, n, (const uint8_t *)nd, m, 0, sr_count_cb, &c_scalar);
+        double t_scalar = now_sec() - t0;
+        t0 = now_sec();
+        c_avx2 = ss_count(text, n, nd, m);
+        double t_avx2 = now_sec() - t0;
+
+        // Same count when fed in odd-sized chunks
+        struct ss_stream st;
+        struct count_chunks cc = {0};
+        if (ss_stream_init(&st, nd, m)) {
+            for (size_t i = 0; i < n;) {
+                size_t len = 1 + (size_t)(rng() % 70000);
+                if (len > n - i) len = n - i;
+                ss_stream_feed(&st, text + i, len, chunk_count_cb, &cc);
+                i += len;
+            }
+            ss_stream_free(&st);
+        }
+        bool ok = c_strstr == c_memmem && c_memmem == c_scalar && c_scalar == c_avx2 && cc.count == c_avx2;
+        double gb = (double)n / 1e9;
+        printf("%-14s %10llu %10.2f %10.2f %10.2f %10.2f  %s\n", nd, (unsigned long long)c_avx2,
+               gb / t_strstr, gb / t_memmem, gb / t_scalar, gb / t_avx2, ok ? "ok" : "MISMATCH");
+    }
+}
+
+static void bench_multi(const char *text, size_t n, size_t npat) {
+    char **pats = malloc(npat * sizeof *pats);
+    if (!pats) { perror("malloc"); return; }
+    size_t made = 0;
+    for (; made < npat; ++made) {
+        pats[made] = malloc(16);
+        if (!pats[made]) break;
+        gen_word(pats[made], 4 + (size_t)(rng() % 8));
+    }
+    npat = made;
+
+    struct ac ac;
+    double t0 = now_sec();
+    if (!ac_build(&ac, (const char *const *)pats, NULL, npat)) { perror("ac_build"); goto out; }
+    double t_build = now_sec() - t0;
+    printf("%zu keywords: %u states, %u classes, %.1f MB automaton (%u B/state), built in %.1f ms\n", npat,
+           ac.nstates, ac.nclasses, ac_bytes(&ac) / 1e6, ac.stride * 4, t_build * 1e3);
+
+    t0 = now_sec();
+    uint64_t c_ac = ac_count(&ac, text, n);
+    double t_ac = now_sec() - t0;
+
+    struct ac_stream st;
+    struct count_chunks cc = {0};
+    ac_stream_init(&ac, &st);
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i += 1 << 16) ac_stream_feed(&ac, &st, text + i, n - i < (1 << 16) ? n - i : 1 << 16, chunk_count_cb, &cc);
+    double t_stream = now_sec() - t0;
+    printf("  aho-corasick: %llu matches, count %.2f GB/s, streamed with callback %.2f GB/s %s\n",
+           (unsigned long long)c_ac, n / 1e9 / t_ac, n / 1e9 / t_stream, cc.count == c_ac ? "ok" : "MISMATCH");
+
+    // One memmem pass per keyword, on the first 100 keywords only
+    size_t sub = npat < 100 ? npat : 100;
+    struct ac ac_sub;
+    if (ac_build(&ac_sub, (const char *const *)pats, NULL, sub)) {
+        t0 = now_sec();
+        uint64_t c_sub = ac_count(&ac_sub, text, n);
+        double t_sub = now_sec() - t0;
+        t0 = now_sec();
+        uint64_t c_loop = 0;
+        for (size_t k = 0; k < sub; ++k) {
+            size_t m = strlen(pats[k]);
+            for (const char *p = text, *end = text + n; (p = memmem(p, (size_t)(end - p), pats[k], m)); ++p) ++c_loop;
+        }
+        double t_loop = now_sec() - t0;
+        printf("  %zu keywords: memmem per keyword %.1f ms, aho-corasick %.1f ms (%.0fx) %s\n", sub,
+               t_loop * 1e3, t_sub * 1e3, t_loop / t_sub, c_loop == c_sub ? "ok" : "MISMATCH");
+        ac_free(&ac_sub);
+    }
+    ac_free(&ac);
+out:
+    for (size_t i = 0; i < npat; ++i) free(pats[i]);
+    free(pats);
+}
+
+int main(int argc, char **argv) {
+    search_kernels_init();
+    size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+    size_t npat = argc > 2 ? strtoul(argv[2], NULL, 10) : 5000;
+    if (!mb) mb = 64;
+    if (!npat) npat = 5000;
+
+    puts("-- Search --");
+    basics_demo();
+
+    size_t n = mb << 20;
+    char *text = gen_text(n);
+    if (!text) { perror("malloc"); return 1; }
+    printf("\n-- Benchmark: single pattern, %zu MB (level %s) --\n", mb, cpu_level_name(cpu_info()->level));
+    bench_single(text, n);
+    printf("\n-- Benchmark: multiple patterns --\n");
+    bench_multi(text, n, npat);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,492 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+// Searching byte buffers for one needle (ss_*) or many keywords at once (ac_*).
+// Both report every occurrence, overlapping ones included, through the same
+// callback and offer first-match, count and all-matches entry points, over a
+// whole buffer or a stream of chunks (matches may straddle chunk borders;
+// positions are absolute offsets in the stream).
+//
+// ss_*: candidates are positions where the needle's first, second AND last
+// byte match, found 32 at a time with three AVX2 compares; only those get their
+// middle compared, inline as two 8-byte words up to SS_INLINE_MAX bytes,
+// with memcmp beyond.
+//
+// ac_*: Aho-Corasick compiled into a DFA (failure links resolved at build
+// time, one table lookup per input byte). Bytes that occur in no keyword
+// share one byte class, so a row has nclasses entries instead of 256, and
+// state ids are premultiplied by the row stride so the hot loop is
+// state = trans[state + cls[byte]]. Matching states are numbered first: a
+// single compare against match_limit detects a match. Each row ends with
+// one more entry, the state's first index into out_ids; the root row comes
+// right after the last matching one, so a match's outputs are the range
+// between its entry and the next row's, without mapping the id back to an
+// index.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cpuprobe.h"
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+#define SR_NONE UINT64_MAX
+#define SS_INLINE_MAX 18      // longest needle whose middle is compared inline
+
+// Return false to stop the scan.
+typedef bool (*sr_match_fn)(uint32_t pattern, uint64_t pos, void *ctx);
+
+// ---- Single pattern ----
+
+typedef bool (*ss_scan_fn)(const uint8_t *h, size_t n, const uint8_t *p, size_t m,
+                           uint64_t base, sr_match_fn cb, void *ctx);
+
+static inline uint64_t ss_load64(const uint8_t *s) {
+    uint64_t v;
+    memcpy(&v, s, sizeof v);
+    return v;
+}
+
+// The needle's middle p[1..m-2] as two words, at +0 and +off1 from the
+// candidate's second byte: they overlap for 8 < len <= 16; below 8 both are
+// the first word, masked to len bytes.
+struct ss_mid {
+    uint64_t w0, w1, mask;
+    size_t off1;
+    bool inl;                 // m <= SS_INLINE_MAX
+};
+
+static inline void ss_mid_init(struct ss_mid *c, const uint8_t *p, size_t m) {
+    uint8_t buf[16] = {0};
+    size_t len = m > 2 ? m - 2 : 0;
+    memset(c, 0, sizeof *c);
+    c->inl = m <= SS_INLINE_MAX;
+    if (!c->inl) return;
+    memcpy(buf, p + 1, len);
+    c->off1 = len > 8 ? len - 8 : 0;
+    c->mask = len >= 8 ? ~0ull : (1ull << (8 * len)) - 1;
+    c->w0 = ss_load64(buf) & c->mask;
+    c->w1 = ss_load64(buf + c->off1) & c->mask;
+}
+
+// s = h + pos + 1; reads s[0, 8 + off1), i.e. up to 8 bytes past the needle.
+static inline bool ss_mid_eq(const struct ss_mid *c, const uint8_t *s) {
+    return (((ss_load64(s) ^ c->w0) | (ss_load64(s + c->off1) ^ c->w1)) & c->mask) == 0;
+}
+
+// Positions [from, n - m] one at a time; m >= 1. Candidates whose word
+// compare would read past n fall back to memcmp.
+static inline bool ss_scan_scalar_from(const uint8_t *h, size_t n, size_t from, const uint8_t *p, size_t m,
+                                       uint64_t base, sr_match_fn cb, void *ctx) {
+    const uint8_t first = p[0], last = p[m - 1];
+    struct ss_mid mid;
+    ss_mid_init(&mid, p, m);
+    const size_t inl_end = mid.inl && n >= 9 ? n - 8 : 0; // word loads stay inside for i < inl_end
+    for (size_t i = from; i + m <= n; ++i) {
+        if (h[i] == first && h[i + m - 1] == last &&
+            (i < inl_end ? ss_mid_eq(&mid, h + i + 1) : m <= 2 || memcmp(h + i + 1, p + 1, m - 2) == 0))
+            if (!cb(0, base + i, ctx)) return false;
+    }
+    return true;
+}
+
+static inline bool ss_scan_scalar(const uint8_t *h, size_t n, const uint8_t *p, size_t m,
+                                  uint64_t base, sr_match_fn cb, void *ctx) {
+    return ss_scan_scalar_from(h, n, 0, p, m, base, cb, ctx);
+}
+
+#ifdef CPU_X86
+CPU_TARGET_AVX2
+static inline bool ss_scan_avx2(const uint8_t *h, size_t n, const uint8_t *p, size_t m,
+                                uint64_t base, sr_match_fn cb, void *ctx) {
+    // The second byte is a third filter: on text, first+last alone pass
+    // about 1 position in 70 for a short common needle, each a likely
+    // branch miss.
+    const size_t o2 = m >= 3 ? 1 : m - 1;
+    const __m256i first = _mm256_set1_epi8((char)p[0]), last = _mm256_set1_epi8((char)p[m - 1]);
+    const __m256i second = _mm256_set1_epi8((char)p[o2]);
+    struct ss_mid mid;
+    ss_mid_init(&mid, p, m);
+    // Block bytes plus the last byte's offset, or the 8 bytes ss_mid_eq may read
+    const size_t reach = 64 + (m - 1 > 8 ? m - 1 : 8);
+    size_t i = 0;
+    for (; i + reach <= n; i += 64) {
+        const uint8_t *s = h + i;
+        __m256i a0 = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)s));
+        __m256i a1 = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(s + 32)));
+        __m256i b0 = _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *)(s + m - 1)));
+        __m256i b1 = _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i *)(s + m - 1 + 32)));
+        __m256i c0 = _mm256_cmpeq_epi8(second, _mm256_loadu_si256((const __m256i *)(s + o2)));
+        __m256i c1 = _mm256_cmpeq_epi8(second, _mm256_loadu_si256((const __m256i *)(s + o2 + 32)));
+        __m256i x0 = _mm256_and_si256(_mm256_and_si256(a0, b0), c0);
+        __m256i x1 = _mm256_and_si256(_mm256_and_si256(a1, b1), c1);
+        if (_mm256_testz_si256(_mm256_or_si256(x0, x1), _mm256_or_si256(x0, x1))) continue;
+        uint64_t mask = (uint32_t)_mm256_movemask_epi8(x0) | (uint64_t)(uint32_t)_mm256_movemask_epi8(x1) << 32;
+        while (mask) {
+            size_t pos = i + (size_t)__builtin_ctzll(mask);
+            bool eq = mid.inl ? ss_mid_eq(&mid, h + pos + 1) : memcmp(h + pos + 1, p + 1, m - 2) == 0;
+            if (eq && !cb(0, base + pos, ctx)) return false;
+            mask &= mask - 1;
+        }
+    }
+    return ss_scan_scalar_from(h, n, i, p, m, base, cb, ctx);
+}
+#endif
+
+// One positional entry per level; C++ has no designated array initializers.
+static const ss_scan_fn ss_scan_table[CPU_LEVEL_COUNT] = {
+    ss_scan_scalar,     // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,               // CPU_LEVEL_SSE42
+    ss_scan_avx2,       // CPU_LEVEL_AVX2
+#endif
+};
+
+static ss_scan_fn ss_scan_impl = ss_scan_scalar;   // until search_kernels_init()
+
+static inline void search_kernels_init(void) { CPU_DISPATCH(ss_scan_impl, ss_scan_table); }
+
+// All occurrences of p in h; an empty needle matches nothing.
+static inline bool ss_each(const void *h, size_t n, const void *p, size_t m, sr_match_fn cb, void *ctx) {
+    if (!m || m > n) return true;
+    return ss_scan_impl((const uint8_t *)h, n, (const uint8_t *)p, m, 0, cb, ctx);
+}
+
+static inline bool sr_first_cb(uint32_t pattern, uint64_t pos, void *ctx) {
+    (void)pattern;
+    *(uint64_t *)ctx = pos;
+    return false;
+}
+
+static inline bool sr_count_cb(uint32_t pattern, uint64_t pos, void *ctx) {
+    (void)pattern; (void)pos;
+    ++*(uint64_t *)ctx;
+    return true;
+}
+
+// Offset of the first occurrence, or SR_NONE.
+static inline uint64_t ss_find(const void *h, size_t n, const void *p, size_t m) {
+    uint64_t pos = SR_NONE;
+    ss_each(h, n, p, m, sr_first_cb, &pos);
+    return pos;
+}
+
+static inline uint64_t ss_count(const void *h, size_t n, const void *p, size_t m) {
+    uint64_t c = 0;
+    ss_each(h, n, p, m, sr_count_cb, &c);
+    return c;
+}
+
+// Streaming: the last m-1 bytes of the previous chunk are kept so matches
+// that straddle a border are found when the next chunk arrives.
+struct ss_stream {
+    const uint8_t *p;     // needle, must outlive the stream
+    size_t m;
+    uint8_t *carry;       // 2*(m-1) bytes: tail of the stream + head of the next chunk
+    size_t carry_len;
+    uint64_t offset;      // stream bytes consumed so far
+};
+
+static inline bool ss_stream_init(struct ss_stream *st, const void *p, size_t m) {
+    memset(st, 0, sizeof *st);
+    st->p = (const uint8_t *)p;
+    st->m = m;
+    st->carry = (uint8_t *)malloc(m > 1 ? 2 * (m - 1) : 1);
+    return st->carry != NULL;
+}
+
+static inline void ss_stream_free(struct ss_stream *st) { free(st->carry); st->carry = NULL; }
+
+struct ss_border { sr_match_fn cb; void *ctx; uint64_t limit; };
+
+// Matches in the border buffer count only if they start in the carried tail.
+static inline bool ss_border_cb(uint32_t pattern, uint64_t pos, void *ctx) {
+    struct ss_border *b = (struct ss_border *)ctx;
+    return pos >= b->limit || b->cb(pattern, pos, b->ctx);
+}
+
+// Returns false if cb stopped the scan.
+static inline bool ss_stream_feed(struct ss_stream *st, const void *chunk, size_t len, sr_match_fn cb, void *ctx) {
+    const uint8_t *c = (const uint8_t *)chunk;
+    size_t keep = st->m - 1;
+    if (!st->m) return true;
+    size_t head = len < keep ? len : keep;
+    memcpy(st->carry + st->carry_len, c, head);
+    if (st->carry_len && st->carry_len + head >= st->m) {
+        struct ss_border b = { cb, ctx, st->offset };
+        if (!ss_scan_impl(st->carry, st->carry_len + head, st->p, st->m, st->offset - st->carry_len,
+                          ss_border_cb, &b)) return false;
+    }
+    if (len >= st->m && !ss_scan_impl(c, len, st->p, st->m, st->offset, cb, ctx)) return false;
+    // New tail: the last keep bytes of carry + chunk
+    if (len >= keep) {
+        memcpy(st->carry, c + len - keep, keep);
+        st->carry_len = keep;
+    } else {
+        size_t total = st->carry_len + len, drop = total > keep ? total - keep : 0;
+        memmove(st->carry, st->carry + drop, total - drop); // chunk bytes were appended above
+        st->carry_len = total - drop;
+    }
+    st->offset += len;
+    return true;
+}
+
+// ---- Aho-Corasick ----
+
+struct ac {
+    uint32_t *trans;        // nstates rows: nclasses premultiplied targets, then the out_ids offset
+    uint8_t cls[256];       // byte -> class
+    uint32_t nclasses, stride, nstates; // stride = nclasses + 1
+    uint32_t start;         // premultiplied root
+    uint32_t match_limit;   // premultiplied ids below this are matching states
+    uint32_t *out_ids;      // pattern ids, longest first
+    uint32_t *pat_len;
+    uint32_t npatterns, max_len;
+};
+
+static inline void ac_free(struct ac *ac) {
+    free(ac->trans);
+    free(ac->out_ids);
+    free(ac->pat_len);
+    memset(ac, 0, sizeof *ac);
+}
+
+// Build from n byte strings (lens may be NULL for C strings). Empty or
+// duplicate patterns are allowed; empty ones never match. False on
+// allocation failure or a table beyond 32-bit premultiplied ids.
+static inline bool ac_build(struct ac *ac, const char *const *pats, const size_t *lens, size_t n) {
+    memset(ac, 0, sizeof *ac);
+    bool ok = false;
+    int32_t *go = NULL;
+    uint32_t *fail = NULL, *term = NULL, *pat_next = NULL, *dict = NULL, *queue = NULL, *order = NULL;
+    uint8_t *matches = NULL;
+    // Declared up front: the goto out paths must not cross initializations in C++
+    size_t total = 0, cap, qh = 0, qt = 0, nout = 0, o = 0;
+    uint32_t k = 1, nc, stride, nstates = 1, nmatch = 0, next, *by_new;
+
+    // Byte classes: every byte used by a pattern gets its own, the rest share 0
+    bool used[256] = {false};
+    ac->pat_len = (uint32_t *)malloc((n ? n : 1) * sizeof *ac->pat_len);
+    if (!ac->pat_len) goto out;
+    for (size_t i = 0; i < n; ++i) {
+        size_t l = lens ? lens[i] : strlen(pats[i]);
+        if (l > UINT32_MAX) goto out;
+        ac->pat_len[i] = (uint32_t)l;
+        total += l;
+        if (l > ac->max_len) ac->max_len = (uint32_t)l;
+        for (size_t j = 0; j < l; ++j) used[(uint8_t)pats[i][j]] = true;
+    }
+    ac->npatterns = (uint32_t)n;
+    for (int b = 0; b < 256; ++b) ac->cls[b] = used[b] ? (uint8_t)(k++ == 256 ? 0 : k - 1) : 0;
+    nc = k > 256 ? 256 : k;
+    ac->nclasses = nc;
+
+    // Trie; at most total+1 states
+    cap = total + 1;
+    stride = nc + 1;
+    if (cap * stride > UINT32_MAX) goto out;
+    go = (int32_t *)malloc(cap * nc * sizeof *go);
+    fail = (uint32_t *)calloc(cap, sizeof *fail);
+    term = (uint32_t *)malloc(cap * sizeof *term);
+    pat_next = (uint32_t *)malloc((n ? n : 1) * sizeof *pat_next);
+    if (!go || !fail || !term || !pat_next) goto out;
+    memset(go, -1, nc * sizeof *go);
+    term[0] = UINT32_MAX;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t s = 0;
+        for (uint32_t j = 0; j < ac->pat_len[i]; ++j) {
+            uint32_t c = ac->cls[(uint8_t)pats[i][j]];
+            if (go[(size_t)s * nc + c] < 0) {
+                memset(go + (size_t)nstates * nc, -1, nc * sizeof *go);
+                term[nstates] = UINT32_MAX;
+                go[(size_t)s * nc + c] = (int32_t)nstates++;
+            }
+            s = (uint32_t)go[(size_t)s * nc + c];
+        }
+        if (s == 0) { pat_next[i] = UINT32_MAX; continue; } // empty pattern
+        pat_next[i] = term[s]; // chain patterns ending here
+        term[s] = (uint32_t)i;
+    }
+
+    // BFS: failure links and full transitions; dict = nearest suffix state
+    // (including itself) that ends a pattern
+    dict = (uint32_t *)malloc(nstates * sizeof *dict);
+    queue = (uint32_t *)malloc(nstates * sizeof *queue);
+    matches = (uint8_t *)calloc(nstates, 1);
+    if (!dict || !queue || !matches) goto out;
+    dict[0] = UINT32_MAX;
+    for (uint32_t c = 0; c < nc; ++c) {
+        int32_t v = go[c];
+        if (v < 0) { go[c] = 0; continue; }
+        fail[v] = 0;
+        queue[qt++] = (uint32_t)v;
+    }
+    while (qh < qt) {
+        uint32_t u = queue[qh++];
+        dict[u] = term[u] != UINT32_MAX ? u : dict[fail[u]];
+        matches[u] = dict[u] != UINT32_MAX;
+        for (uint32_t c = 0; c < nc; ++c) {
+            int32_t v = go[(size_t)u * nc + c];
+            int32_t via_fail = go[(size_t)fail[u] * nc + c];
+            if (v < 0) { go[(size_t)u * nc + c] = via_fail; continue; }
+            fail[v] = (uint32_t)via_fail;
+            queue[qt++] = (uint32_t)v;
+        }
+    }
+
+    // Renumber: matching states first, each group in BFS order so the shallow
+    // states most inputs stay in share cache lines
+    order = (uint32_t *)malloc(nstates * sizeof *order); // old -> new index
+    if (!order) goto out;
+    for (size_t i = 0; i < qt; ++i) if (matches[queue[i]]) order[queue[i]] = nmatch++;
+    next = nmatch;
+    order[0] = next++;
+    for (size_t i = 0; i < qt; ++i) if (!matches[queue[i]]) order[queue[i]] = next++;
+
+    ac->trans = (uint32_t *)malloc((size_t)nstates * stride * sizeof *ac->trans);
+    if (!ac->trans) goto out;
+    for (uint32_t s = 0; s < nstates; ++s)
+        for (uint32_t c = 0; c < nc; ++c)
+            ac->trans[(size_t)order[s] * stride + c] = order[go[(size_t)s * nc + c]] * stride;
+
+    // Outputs: walk the dictionary-suffix chain of every matching state
+    for (uint32_t s = 0; s < nstates; ++s) {
+        if (!matches[s]) continue;
+        for (uint32_t d = dict[s]; d != UINT32_MAX; d = dict[fail[d]])
+            for (uint32_t p = term[d]; p != UINT32_MAX; p = pat_next[p]) ++nout;
+    }
+    ac->out_ids = (uint32_t *)malloc((nout ? nout : 1) * sizeof *ac->out_ids);
+    if (!ac->out_ids) goto out;
+    // Fill in new-index order so the rows' out_ids offsets are a prefix sum;
+    // every later row, the root first, holds the total
+    by_new = queue; // reuse: new match index -> old state
+    for (uint32_t s = 0; s < nstates; ++s) if (matches[s]) by_new[order[s]] = s;
+    for (uint32_t i = 0; i < nmatch; ++i) {
+        ac->trans[(size_t)i * stride + nc] = (uint32_t)o;
+        for (uint32_t d = dict[by_new[i]]; d != UINT32_MAX; d = dict[fail[d]])
+            for (uint32_t p = term[d]; p != UINT32_MAX; p = pat_next[p]) ac->out_ids[o++] = p;
+    }
+    for (uint32_t i = nmatch; i < nstates; ++i) ac->trans[(size_t)i * stride + nc] = (uint32_t)o;
+
+    ac->stride = stride;
+    ac->nstates = nstates;
+    ac->start = order[0] * stride;
+    ac->match_limit = nmatch * stride;
+    ok = true;
+out:
+    free(go); free(fail); free(term); free(pat_next); free(dict); free(queue); free(order); free(matches);
+    if (!ok) ac_free(ac);
+    return ok;
+}
+
+static inline size_t ac_bytes(const struct ac *ac) {
+    return (size_t)ac->nstates * ac->stride * 4 + (size_t)ac->trans[ac->start + ac->nclasses] * 4;
+}
+
+// Core loop; *state carries across calls, base is the offset of s[0].
+static inline bool ac_scan(const struct ac *ac, uint32_t *state, const uint8_t *s, size_t n, uint64_t base,
+                           sr_match_fn cb, void *ctx) {
+    const uint32_t *trans = ac->trans, *out = trans + ac->nclasses; // out[st]: st's out_ids offset
+    const uint8_t *cls = ac->cls;
+    uint32_t st = *state, limit = ac->match_limit, stride = ac->stride;
+    for (size_t i = 0; i < n; ++i) {
+        st = trans[st + cls[s[i]]];
+        if (st < limit) {
+            uint64_t end = base + i + 1;
+            for (uint32_t k = out[st]; k < out[st + stride]; ++k) {
+                uint32_t p = ac->out_ids[k];
+                if (!cb(p, end - ac->pat_len[p], ctx)) { *state = st; return false; }
+            }
+        }
+    }
+    *state = st;
+    return true;
+}
+
+// All matches in h, as (pattern, start offset), ordered by end offset.
+static inline bool ac_each(const struct ac *ac, const void *h, size_t n, sr_match_fn cb, void *ctx) {
+    uint32_t st = ac->start;
+    return ac_scan(ac, &st, (const uint8_t *)h, n, 0, cb, ctx);
+}
+
+static inline uint64_t ac_count_range(const struct ac *ac, uint32_t *state, const uint8_t *s, size_t n) {
+    const uint32_t *trans = ac->trans, *out = trans + ac->nclasses;
+    const uint8_t *cls = ac->cls;
+    uint32_t st = *state, limit = ac->match_limit, stride = ac->stride;
+    uint64_t c = 0;
+    for (size_t i = 0; i < n; ++i) {
+        st = trans[st + cls[s[i]]];
+        if (st < limit) c += out[st + stride] - out[st];
+    }
+    *state = st;
+    return c;
+}
+
+#define AC_LANES 4
+
+// Total matches without the callback per match. Each byte is a load that
+// depends on the previous one, so the walk is latency bound; large buffers
+// are split into AC_LANES segments walked in lockstep. A lane entering
+// mid-buffer starts max_len bytes early from the root (matches there are
+// discarded): the DFA state only depends on that many trailing bytes.
+static inline uint64_t ac_count(const struct ac *ac, const void *h, size_t n) {
+    const uint8_t *s = (const uint8_t *)h;
+    uint32_t st[AC_LANES];
+    size_t seg = n / AC_LANES;
+    if (seg < 4 * (size_t)ac->max_len + 256) {
+        st[0] = ac->start;
+        return ac_count_range(ac, &st[0], s, n);
+    }
+    const uint32_t *trans = ac->trans, *out = trans + ac->nclasses;
+    const uint8_t *cls = ac->cls, *p[AC_LANES];
+    const uint32_t limit = ac->match_limit, stride = ac->stride;
+    for (int k = 0; k < AC_LANES; ++k) {
+        p[k] = s + (size_t)k * seg;
+        st[k] = ac->start;
+        if (k) ac_count_range(ac, &st[k], p[k] - ac->max_len, ac->max_len);
+    }
+    uint64_t c = 0;
+    for (size_t i = 0; i < seg; ++i) {
+        for (int k = 0; k < AC_LANES; ++k) {
+            st[k] = trans[st[k] + cls[p[k][i]]];
+            if (st[k] < limit) c += out[st[k] + stride] - out[st[k]];
+        }
+    }
+    // The last lane also takes the remainder
+    return c + ac_count_range(ac, &st[AC_LANES - 1], s + AC_LANES * seg, n - AC_LANES * seg);
+}
+
+struct ac_first { uint32_t pattern; uint64_t pos; };
+
+static inline bool ac_first_cb(uint32_t pattern, uint64_t pos, void *ctx) {
+    struct ac_first *f = (struct ac_first *)ctx;
+    f->pattern = pattern;
+    f->pos = pos;
+    return false;
+}
+
+// The match that ends first (longest pattern on ties); false if none.
+static inline bool ac_find(const struct ac *ac, const void *h, size_t n, uint32_t *pattern, uint64_t *pos) {
+    struct ac_first f = { 0, SR_NONE };
+    ac_each(ac, h, n, ac_first_cb, &f);
+    if (f.pos == SR_NONE) return false;
+    *pattern = f.pattern;
+    *pos = f.pos;
+    return true;
+}
+
+struct ac_stream { uint32_t state; uint64_t offset; };
+
+static inline void ac_stream_init(const struct ac *ac, struct ac_stream *st) { st->state = ac->start; st->offset = 0; }
+
+static inline bool ac_stream_feed(const struct ac *ac, struct ac_stream *st, const void *chunk, size_t len,
+                                  sr_match_fn cb, void *ctx) {
+    bool more = ac_scan(ac, &st->state, (const uint8_t *)chunk, len, st->offset, cb, ctx);
+    st->offset += len;
+    return more;
+}
+
+#endif // SEARCH_H
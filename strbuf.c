@@ -0,0 +1,147 @@
+// Build: gcc -O2 strbuf.c -o build/strbuf
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "strbuf.h"
+
+#define LEN(x) (sizeof(x)/sizeof((x)[0]))
+
+// ---- Demos ----
+
+// The string_basics example from arrstr.c, without capacity arithmetic
+static void basics_demo(void) {
+    struct strbuf sb;
+    sb_init(&sb);
+    sb_append_cstr(&sb, "world");
+    printf("buf: '%s' (len=%zu, cap=%zu, inline=%d)\n", sb_cstr(&sb), sb_len(&sb), sb.cap, sb_is_inline(&sb));
+    sb_append_cstr(&sb, "!!!");
+    printf("concat: '%s'\n", sb_cstr(&sb));
+
+    // snprintf into dst[8] truncates silently; the builder just grows
+    char dst[8];
+    snprintf(dst, sizeof dst, "%s-%s", "ab", "cdEFGH");
+    sb_clear(&sb);
+    sb_appendf(&sb, "%s-%s", "ab", "cdEFGH");
+    printf("snprintf: '%s' vs sb_appendf: '%s'\n", dst, sb_cstr(&sb));
+
+    const char *colors[] = {"red", "green", "blue"};
+    sb_clear(&sb);
+    sb_join(&sb, colors, LEN(colors), ", ");
+    printf("join: '%s'\n", sb_cstr(&sb));
+
+    // Crossing the inline limit moves to the heap transparently
+    for (int i = 0; i < 10; ++i) sb_appendf(&sb, " #%d", i);
+    printf("grown: '%s' (len=%zu, cap=%zu, inline=%d)\n", sb_cstr(&sb), sb_len(&sb), sb.cap, sb_is_inline(&sb));
+
+    // Appending a builder to itself: the source moves with the reallocation
+    sb_clear(&sb);
+    sb_append_cstr(&sb, "abcdefghijklmnopqrstuvwxyz0123456789");
+    sb_append(&sb, sb_cstr(&sb), sb_len(&sb));
+    const char *halves[] = {sb_cstr(&sb) + 36, "|", sb_cstr(&sb) + 62};
+    sb_join(&sb, halves, LEN(halves), NULL);
+    printf("self-append: %s (len=%zu)\n",
+           sb_len(&sb) == 72 + 36 + 1 + 10 && memcmp(sb_cstr(&sb) + 72, sb_cstr(&sb), 36) == 0 &&
+           strcmp(sb_cstr(&sb) + 108, "|0123456789") == 0 ? "ok" : "MISMATCH", sb_len(&sb));
+
+    struct strbuf moved;
+    sb_move(&moved, &sb); // heap buffer changes hands, no copy
+    sb_append_char(&moved, '.');
+    char *owned = sb_detach(&moved); // replaces safe_strdup-style copies
+    if (owned) { printf("detached: '%.20s...%s'\n", owned, owned + strlen(owned) - 3); free(owned); }
+    sb_free(&sb);
+}
+
+// ---- Benchmark ----
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static char *safe_strdup(const char *s) {
+    if (!s) return NULL;
+    size_t len = strlen(s) + 1;
+    char *p = malloc(len);
+    if (!p) return NULL;
+    memcpy(p, s, len);
+    return p;
+}
+
+static void bench(void) {
+    const size_t n = 50000;
+    const char *tok = "token,";
+    size_t cap = n * 16 + 1;
+    char *buf = malloc(cap);
+    if (!buf) { perror("malloc"); return; }
+
+    // strncat: rescans the destination each call -> O(n^2)
+    double t0 = now_sec();
+    buf[0] = '\0';
+    for (size_t i = 0; i < n; ++i) strncat(buf, tok, cap - strlen(buf) - 1);
+    double t_strncat = now_sec() - t0;
+    size_t expect = strlen(buf);
+
+    // snprintf at a tracked offset: linear, but reformats every time
+    t0 = now_sec();
+    size_t off = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int w = snprintf(buf + off, cap - off, "%s", tok);
+        if (w > 0) off += (size_t)w;
+    }
+    double t_snprintf = now_sec() - t0;
+
+    struct strbuf sb;
+    sb_init(&sb);
+    t0 = now_sec();
+    for (size_t i = 0; i < n; ++i) sb_append(&sb, tok, 6);
+    double t_sb = now_sec() - t0;
+    bool ok = sb_len(&sb) == expect && off == expect;
+
+    sb_clear(&sb);
+    t0 = now_sec();
+    for (size_t i = 0; i < n; ++i) sb_appendf(&sb, "%zu,", i);
+    double t_sbf = now_sec() - t0;
+    sb_free(&sb);
+
+    printf("append %zu tokens:\n", n);
+    printf("  strncat:          %8.3f ms\n", t_strncat * 1e3);
+    printf("  snprintf+offset:  %8.3f ms\n", t_snprintf * 1e3);
+    printf("  sb_append:        %8.3f ms %s\n", t_sb * 1e3, ok ? "ok" : "MISMATCH");
+    printf("  sb_appendf(%%zu):  %8.3f ms\n", t_sbf * 1e3);
+    free(buf);
+
+    // Short strings: heap copy per string vs inline storage
+    const size_t m = 1000000;
+    size_t sink = 0;
+    t0 = now_sec();
+    for (size_t i = 0; i < m; ++i) {
+        char *p = safe_strdup("Alice");
+        if (p) { sink += (size_t)p[i % 5]; free(p); }
+    }
+    double t_dup = now_sec() - t0;
+    t0 = now_sec();
+    for (size_t i = 0; i < m; ++i) {
+        struct strbuf s;
+        sb_init(&s);
+        sb_append(&s, "Alice", 5);
+        sink += (size_t)sb_cstr(&s)[i % 5];
+        sb_free(&s);
+    }
+    double t_sso = now_sec() - t0;
+    printf("%zu short copies: safe_strdup %.2f ms, inline strbuf %.2f ms (sink %zu)\n",
+           m, t_dup * 1e3, t_sso * 1e3, sink);
+}
+
+int main(void) {
+    puts("-- String Builder --");
+    basics_demo();
+
+    puts("\n-- Benchmark --");
+    bench();
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#ifndef STRBUF_H
+#define STRBUF_H
+
+// Length-tracked string builder with small-string optimization.
+// Strings of up to SB_INLINE bytes live inside the struct (no heap); longer
+// ones move to the heap and grow geometrically, so appends are amortized
+// O(1) and never rescan the contents. The data is always NUL-terminated,
+// so sb_cstr() is free. ptr may point into the struct itself: do not copy a
+// strbuf by value, use sb_move().
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SB_INLINE 39
+
+struct strbuf {
+    char *ptr;      // small or heap storage
+    size_t len;     // bytes used, excluding NUL
+    size_t cap;     // bytes available, excluding NUL
+    char small[SB_INLINE + 1];
+};
+
+static inline void sb_init(struct strbuf *sb) {
+    sb->ptr = sb->small;
+    sb->len = 0;
+    sb->cap = SB_INLINE;
+    sb->small[0] = '\0';
+}
+
+static inline bool sb_is_inline(const struct strbuf *sb) { return sb->ptr == sb->small; }
+
+static inline void sb_free(struct strbuf *sb) {
+    if (!sb_is_inline(sb)) free(sb->ptr);
+    sb_init(sb);
+}
+
+static inline const char *sb_cstr(const struct strbuf *sb) { return sb->ptr; }
+static inline size_t sb_len(const struct strbuf *sb) { return sb->len; }
+
+// Keep the capacity, drop the contents.
+static inline void sb_clear(struct strbuf *sb) {
+    sb->len = 0;
+    sb->ptr[0] = '\0';
+}
+
+// Make room for extra more bytes. Growth doubles so repeated appends stay
+// amortized O(1). On failure the buffer is left unchanged.
+static inline bool sb_reserve(struct strbuf *sb, size_t extra) {
+    if (extra <= sb->cap - sb->len) return true;
+    if (extra > (size_t)-1 / 2 - sb->len) return false; // overflow
+    size_t need = sb->len + extra;
+    size_t cap = sb->cap * 2;
+    if (cap < need) cap = need;
+
+    char *p;
+    if (sb_is_inline(sb)) {
+        p = (char *)malloc(cap + 1);
+        if (!p) return false;
+        memcpy(p, sb->small, sb->len + 1);
+    } else {
+        p = (char *)realloc(sb->ptr, cap + 1);
+        if (!p) return false; // original ptr still valid
+    }
+    sb->ptr = p;
+    sb->cap = cap;
+    return true;
+}
+
+// True if s points into sb's current contents (including the NUL).
+static inline bool sb_owns(const struct strbuf *sb, const char *s) {
+    return (uintptr_t)s - (uintptr_t)sb->ptr <= sb->len;
+}
+
+// s may point into sb itself (appending a builder to itself or a slice of
+// it): its offset is kept across the reallocation in sb_reserve().
+static inline bool sb_append(struct strbuf *sb, const char *s, size_t n) {
+    size_t off = (uintptr_t)s - (uintptr_t)sb->ptr;
+    bool own = sb_owns(sb, s);
+    if (!sb_reserve(sb, n)) return false;
+    if (own) s = sb->ptr + off;
+    memcpy(sb->ptr + sb->len, s, n);
+    sb->len += n;
+    sb->ptr[sb->len] = '\0';
+    return true;
+}
+
+static inline bool sb_append_cstr(struct strbuf *sb, const char *s) {
+    return sb_append(sb, s, strlen(s));
+}
+
+static inline bool sb_append_char(struct strbuf *sb, char c) {
+    if (sb->len == sb->cap && !sb_reserve(sb, 1)) return false;
+    sb->ptr[sb->len++] = c;
+    sb->ptr[sb->len] = '\0';
+    return true;
+}
+
+// printf-style append. Formats straight into the spare capacity and only
+// formats a second time when that was too small; never truncates. Arguments
+// must not point into sb (vsnprintf's source and destination may not overlap).
+static inline bool sb_appendf(struct strbuf *sb, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    size_t avail = sb->cap - sb->len;
+    int n = vsnprintf(sb->ptr + sb->len, avail + 1, fmt, ap);
+    va_end(ap);
+    if (n < 0) { sb->ptr[sb->len] = '\0'; return false; }
+    if ((size_t)n > avail) {
+        if (!sb_reserve(sb, (size_t)n)) { sb->ptr[sb->len] = '\0'; return false; }
+        va_start(ap, fmt);
+        vsnprintf(sb->ptr + sb->len, (size_t)n + 1, fmt, ap);
+        va_end(ap);
+    }
+    sb->len += (size_t)n;
+    return true;
+}
+
+// Append parts separated by sep with a single reservation. Parts that point
+// into sb itself are joined into a temporary first: the reservation may move
+// them, and writing the result overwrites their terminating NUL.
+static inline bool sb_join(struct strbuf *sb, const char *const *parts, size_t n, const char *sep) {
+    size_t seplen = sep ? strlen(sep) : 0;
+    size_t total = n > 1 ? seplen * (n - 1) : 0;
+    bool own = sep && sb_owns(sb, sep);
+    for (size_t i = 0; i < n; ++i) {
+        total += strlen(parts[i]);
+        own |= sb_owns(sb, parts[i]);
+    }
+    if (own) {
+        struct strbuf tmp;
+        sb_init(&tmp);
+        bool ok = sb_join(&tmp, parts, n, sep) && sb_append(sb, tmp.ptr, tmp.len);
+        sb_free(&tmp);
+        return ok;
+    }
+    if (!sb_reserve(sb, total)) return false;
+    char *p = sb->ptr + sb->len;
+    for (size_t i = 0; i < n; ++i) {
+        if (i && seplen) { memcpy(p, sep, seplen); p += seplen; }
+        size_t l = strlen(parts[i]);
+        memcpy(p, parts[i], l);
+        p += l;
+    }
+    sb->len += total;
+    sb->ptr[sb->len] = '\0';
+    return true;
+}
+
+// Transfer ownership from src to dst (dst must be empty or freed); src is reset.
+static inline void sb_move(struct strbuf *dst, struct strbuf *src) {
+    if (sb_is_inline(src)) {
+        sb_init(dst);
+        memcpy(dst->small, src->small, src->len + 1);
+        dst->len = src->len;
+    } else {
+        *dst = *src;
+    }
+    sb_init(src);
+}
+
+// Hand the contents to the caller as a malloc'ed C string (free() it).
+// Heap strings are returned without copying.
+static inline char *sb_detach(struct strbuf *sb) {
+    char *out;
+    if (sb_is_inline(sb)) {
+        out = (char *)malloc(sb->len + 1);
+        if (!out) return NULL;
+        memcpy(out, sb->small, sb->len + 1);
+    } else {
+        out = sb->ptr;
+    }
+    sb_init(sb);
+    return out;
+}
+
+#endif // STRBUF_H
@@ -0,0 +1,136 @@
+// Build: gcc -O2 -pthread tpool.c -o build/tpool -lm
+// Usage: build/tpool [max_threads]
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "cpuprobe.h"
+#include "tpool.h"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// ---- parallel_reduce: the sum_array pattern from functrl.c ----
+
+static void sum_map(size_t lo, size_t hi, void *acc, void *ctx) {
+    const int32_t *a = ctx;
+    int64_t s = 0;
+    for (size_t i = lo; i < hi; ++i) s += a[i];
+    *(int64_t *)acc += s;
+}
+
+static void sum_combine(void *acc, const void *other, void *ctx) {
+    (void)ctx;
+    *(int64_t *)acc += *(const int64_t *)other;
+}
+
+static int64_t parallel_sum(struct tp_pool *pool, const int32_t *a, size_t n) {
+    int64_t total = 0; // identity
+    if (!tp_parallel_reduce(pool, 0, n, 0, &total, sizeof total, sum_map, sum_combine, (void *)a)) {
+        fprintf(stderr, "parallel_reduce: out of memory\n");
+    }
+    return total;
+}
+
+// ---- parallel_for: a per-element transform ----
+
+struct transform_ctx { const float *x; float *y; float a, b; };
+
+static void transform_body(size_t lo, size_t hi, void *p) {
+    struct transform_ctx *c = p;
+    for (size_t i = lo; i < hi; ++i) c->y[i] = c->a * sqrtf(c->x[i]) + c->b;
+}
+
+// ---- task groups: nested spawns with a sequential cutoff ----
+
+struct fib_arg { int n; long result; struct tp_pool *pool; };
+
+static long fib_seq(int n) { return n < 2 ? n : fib_seq(n - 1) + fib_seq(n - 2); }
+
+static void fib_task(void *p) {
+    struct fib_arg *f = p;
+    if (f->n < 20) { f->result = fib_seq(f->n); return; }
+    struct fib_arg left = { f->n - 1, 0, f->pool };
+    struct fib_arg right = { f->n - 2, 0, f->pool };
+    struct tp_group g = TP_GROUP_INIT;
+    tp_spawn(f->pool, &g, fib_task, &left); // may be stolen
+    fib_task(&right);                       // keep working meanwhile
+    tp_wait(f->pool, &g);
+    f->result = left.result + right.result;
+}
+
+static void demos(struct tp_pool *pool) {
+    int demo[] = {1, 2, 3, 4, 5};
+    printf("parallel sum_array([1..5]) = %lld\n",
+           (long long)parallel_sum(pool, demo, sizeof demo / sizeof demo[0]));
+
+    struct fib_arg f = { 30, 0, pool };
+    struct tp_group g = TP_GROUP_INIT;
+    double t0 = now_sec();
+    tp_spawn(pool, &g, fib_task, &f);
+    tp_wait(pool, &g);
+    printf("task-group fib(30) = %ld (%.3f s, expect %ld)\n", f.result, now_sec() - t0, fib_seq(30));
+}
+
+// ---- scaling benchmark ----
+
+static void scaling_bench(unsigned max_threads) {
+    size_t n = (size_t)1 << 24;
+    int32_t *a = malloc(n * sizeof *a);
+    float *x = malloc(n * sizeof *x);
+    float *y = malloc(n * sizeof *y);
+    if (!a || !x || !y) { perror("malloc"); free(a); free(x); free(y); return; }
+    int64_t expect = 0;
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = (int32_t)(i % 1000) - 500;
+        expect += a[i];
+        x[i] = (float)(i & 0xFFFF);
+    }
+
+    printf("%-8s %12s %8s %12s %8s\n", "threads", "reduce ms", "speedup", "transform ms", "speedup");
+    double base_r = 0, base_t = 0;
+    for (unsigned t = 1; t <= max_threads; t = (t * 2 > max_threads && t != max_threads) ? max_threads : t * 2) {
+        struct tp_pool *pool = tp_create(t);
+        if (!pool) { fprintf(stderr, "tp_create(%u) failed\n", t); break; }
+        int reps = 10;
+
+        int64_t s = 0;
+        double t0 = now_sec();
+        for (int r = 0; r < reps; ++r) s = parallel_sum(pool, a, n);
+        double tr = (now_sec() - t0) / reps;
+
+        struct transform_ctx tc = { x, y, 0.5f, 1.0f };
+        t0 = now_sec();
+        for (int r = 0; r < reps; ++r) tp_parallel_for(pool, 0, n, 0, transform_body, &tc);
+        double tt = (now_sec() - t0) / reps;
+
+        if (t == 1) { base_r = tr; base_t = tt; }
+        printf("%-8u %12.2f %7.2fx %12.2f %7.2fx%s\n", t, tr * 1e3, base_r / tr, tt * 1e3, base_t / tt,
+               s == expect && y[12345] == 0.5f * sqrtf(x[12345]) + 1.0f ? "" : "  MISMATCH");
+        tp_destroy(pool);
+    }
+    free(a); free(x); free(y);
+}
+
+int main(int argc, char **argv) {
+    unsigned max_threads = cpu_info()->logical_cpus;
+    if (argc > 1) max_threads = (unsigned)strtoul(argv[1], NULL, 10);
+    if (max_threads == 0) max_threads = 1;
+
+    puts("-- Thread Pool Demos --");
+    struct tp_pool *pool = tp_create(max_threads);
+    if (!pool) { fprintf(stderr, "tp_create failed\n"); return 1; }
+    printf("workers: %u (logical cpus: %u)\n", tp_size(pool), cpu_info()->logical_cpus);
+    demos(pool);
+    tp_destroy(pool);
+
+    puts("\n-- Scaling: reduction and transform --");
+    scaling_bench(max_threads);
+
+    return 0;
+}
@@ -0,0 +1,512 @@
+#ifndef TPOOL_H
+#define TPOOL_H
+
+// Header-only work-stealing thread pool for the repo's loop-heavy kernels.
+//
+// Each worker owns a Chase-Lev deque: it pushes and pops at the bottom, idle
+// workers steal from the top of a random victim. Threads that are not pool
+// workers submit through a small mutex-protected injection queue. The thread
+// that calls tp_create() becomes worker 0 and executes tasks while it waits,
+// so a pool of N threads starts N-1 background threads.
+//
+// Usable from C (tp_* functions) and C++ (tp::Pool / tp::TaskGroup below).
+// Build with -pthread.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TP_DEQUE_CAP 8192 // per-worker deque slots (power of two)
+#define TP_SPIN 256       // idle polls before a worker goes to sleep
+#define TP_CACHELINE 64
+
+// Counts outstanding tasks; tp_wait() returns once it drops to zero.
+struct tp_group { long pending; };
+#define TP_GROUP_INIT { 0 }
+
+struct tp_pool;
+struct tp_task;
+
+typedef void (*tp_task_fn)(void *arg);
+typedef void (*tp_range_fn)(size_t lo, size_t hi, void *ctx);
+
+// One schedulable unit. Plain tasks use fn/arg; parallel_for ranges use
+// lo/hi and split themselves further before running.
+struct tp_task {
+    void (*run)(struct tp_task *t);
+    struct tp_group *group;
+    struct tp_pool *pool;
+    tp_task_fn fn;
+    void *arg;
+    size_t lo, hi, grain;
+    tp_range_fn body;
+};
+
+struct tp_deque {
+    long top;                       // stolen from here (any thread)
+    char pad0[TP_CACHELINE - sizeof(long)];
+    long bottom;                    // pushed/popped here (owner only)
+    char pad1[TP_CACHELINE - sizeof(long)];
+    struct tp_task *slots[TP_DEQUE_CAP];
+};
+
+struct tp_worker {
+    struct tp_deque dq;
+    struct tp_pool *pool;
+    struct tp_worker *prev_self;    // restored when the owner destroys the pool
+    unsigned index;
+    unsigned rng;
+    pthread_t thread;
+};
+
+struct tp_pool {
+    unsigned nworkers;
+    struct tp_worker *workers;
+
+    pthread_mutex_t lock;           // guards inject queue and sleeping
+    pthread_cond_t wake;
+    struct tp_task **inject;        // ring buffer FIFO for external submitters
+    size_t inject_head, inject_len, inject_cap;
+
+    long epoch;                     // bumped on every submit (wakeup protocol)
+    long sleepers;
+    int stop;
+};
+
+// Worker the current thread acts as (NULL for external threads).
+static __thread struct tp_worker *tp_self;
+
+static inline void tp_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// ---- Chase-Lev deque (Le, Pop, Cohen, Zappa Nardelli 2013 orderings) ----
+
+static inline bool tp_deque_push(struct tp_deque *d, struct tp_task *t) {
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    long top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    if (b - top >= TP_DEQUE_CAP) return false; // full: caller runs inline
+    __atomic_store_n(&d->slots[b & (TP_DEQUE_CAP - 1)], t, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+static inline struct tp_task *tp_deque_pop(struct tp_deque *d) {
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long top = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+    struct tp_task *t = NULL;
+    if (top <= b) {
+        t = __atomic_load_n(&d->slots[b & (TP_DEQUE_CAP - 1)], __ATOMIC_RELAXED);
+        if (top == b) { // last element: race against thieves
+            if (!__atomic_compare_exchange_n(&d->top, &top, top + 1, false,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                t = NULL;
+            __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return t;
+}
+
+static inline struct tp_task *tp_deque_steal(struct tp_deque *d) {
+    long top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+    if (top >= b) return NULL;
+    struct tp_task *t = __atomic_load_n(&d->slots[top & (TP_DEQUE_CAP - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&d->top, &top, top + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return NULL; // lost the race; caller moves on to another victim
+    return t;
+}
+
+// ---- Scheduling ----
+
+static inline struct tp_worker *tp_current(struct tp_pool *pool) {
+    return (tp_self && tp_self->pool == pool) ? tp_self : NULL;
+}
+
+// Announce new work; wakes a sleeper if there is one. The epoch store and the
+// sleepers load pair with the reverse order in tp_worker_main (Dekker style).
+static inline void tp_notify(struct tp_pool *pool, bool all) {
+    __atomic_add_fetch(&pool->epoch, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool->sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&pool->lock);
+        if (all) pthread_cond_broadcast(&pool->wake);
+        else pthread_cond_signal(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static inline bool tp_inject(struct tp_pool *pool, struct tp_task *t) {
+    pthread_mutex_lock(&pool->lock);
+    if (pool->inject_len == pool->inject_cap) {
+        size_t cap = pool->inject_cap ? pool->inject_cap * 2 : 64;
+        struct tp_task **q = (struct tp_task **)malloc(cap * sizeof *q);
+        if (!q) { pthread_mutex_unlock(&pool->lock); return false; }
+        for (size_t i = 0; i < pool->inject_len; ++i)
+            q[i] = pool->inject[(pool->inject_head + i) % pool->inject_cap];
+        free(pool->inject);
+        pool->inject = q;
+        pool->inject_head = 0;
+        pool->inject_cap = cap;
+    }
+    pool->inject[(pool->inject_head + pool->inject_len) % pool->inject_cap] = t;
+    __atomic_store_n(&pool->inject_len, pool->inject_len + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+static inline struct tp_task *tp_take_injected(struct tp_pool *pool) {
+    if (__atomic_load_n(&pool->inject_len, __ATOMIC_ACQUIRE) == 0) return NULL;
+    struct tp_task *t = NULL;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->inject_len) {
+        t = pool->inject[pool->inject_head];
+        pool->inject_head = (pool->inject_head + 1) % pool->inject_cap;
+        __atomic_store_n(&pool->inject_len, pool->inject_len - 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return t;
+}
+
+// Own deque first, then the injection queue, then one pass over victims.
+static inline struct tp_task *tp_find_task(struct tp_pool *pool, struct tp_worker *w) {
+    struct tp_task *t = NULL;
+    if (w && (t = tp_deque_pop(&w->dq))) return t;
+    if ((t = tp_take_injected(pool))) return t;
+
+    unsigned n = pool->nworkers;
+    unsigned start = 0;
+    if (w) {
+        w->rng ^= w->rng << 13; w->rng ^= w->rng >> 17; w->rng ^= w->rng << 5;
+        start = w->rng % n;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        struct tp_worker *v = &pool->workers[(start + i) % n];
+        if (v == w) continue;
+        if ((t = tp_deque_steal(&v->dq))) return t;
+    }
+    return NULL;
+}
+
+static inline void tp_execute(struct tp_task *t) {
+    struct tp_group *g = t->group;
+    t->run(t);
+    free(t);
+    __atomic_sub_fetch(&g->pending, 1, __ATOMIC_RELEASE);
+}
+
+// Queue t on the caller's deque (or the injection queue); runs it inline if
+// neither has room.
+static inline void tp_submit(struct tp_pool *pool, struct tp_task *t) {
+    __atomic_add_fetch(&t->group->pending, 1, __ATOMIC_RELAXED);
+    struct tp_worker *w = tp_current(pool);
+    bool queued = w ? tp_deque_push(&w->dq, t) : tp_inject(pool, t);
+    if (!queued) { tp_execute(t); return; }
+    tp_notify(pool, !w);
+}
+
+static inline void *tp_worker_main(void *arg) {
+    struct tp_worker *w = (struct tp_worker *)arg;
+    struct tp_pool *pool = w->pool;
+    tp_self = w;
+    unsigned idle = 0;
+    for (;;) {
+        struct tp_task *t = tp_find_task(pool, w);
+        if (t) { tp_execute(t); idle = 0; continue; }
+        if (++idle < TP_SPIN) { tp_relax(); continue; }
+
+        long seen = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+        if ((t = tp_find_task(pool, w))) { tp_execute(t); idle = 0; continue; }
+
+        pthread_mutex_lock(&pool->lock);
+        __atomic_add_fetch(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+        while (!pool->stop && __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST) == seen)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        __atomic_sub_fetch(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+        int stop = pool->stop;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+        idle = 0;
+    }
+    return NULL;
+}
+
+// ---- Public C API ----
+
+// Create a pool of nthreads workers (0 = online CPUs), counting the calling
+// thread as worker 0. Returns NULL on failure.
+static inline struct tp_pool *tp_create(unsigned nthreads) {
+    if (nthreads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = n > 0 ? (unsigned)n : 1;
+    }
+    struct tp_pool *pool = (struct tp_pool *)calloc(1, sizeof *pool);
+    if (!pool) return NULL;
+    void *mem = NULL;
+    if (posix_memalign(&mem, TP_CACHELINE, nthreads * sizeof(struct tp_worker)) != 0) {
+        free(pool);
+        return NULL;
+    }
+    memset(mem, 0, nthreads * sizeof(struct tp_worker));
+    pool->workers = (struct tp_worker *)mem;
+    pool->nworkers = nthreads;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for (unsigned i = 0; i < nthreads; ++i) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        pool->workers[i].rng = 2463534242u + i * 7919u;
+    }
+    pool->workers[0].prev_self = tp_self;
+    tp_self = &pool->workers[0];
+
+    for (unsigned i = 1; i < nthreads; ++i) {
+        if (pthread_create(&pool->workers[i].thread, NULL, tp_worker_main, &pool->workers[i]) != 0) {
+            perror("pthread_create");
+            pool->nworkers = i; // run with the workers we managed to start
+            break;
+        }
+    }
+    return pool;
+}
+
+// Stop and join the workers. All task groups must have been waited on.
+static inline void tp_destroy(struct tp_pool *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (unsigned i = 1; i < pool->nworkers; ++i) pthread_join(pool->workers[i].thread, NULL);
+    if (tp_self == &pool->workers[0]) tp_self = pool->workers[0].prev_self;
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->inject);
+    free(pool->workers);
+    free(pool);
+}
+
+static inline unsigned tp_size(const struct tp_pool *pool) { return pool->nworkers; }
+
+static inline void tp_run_plain(struct tp_task *t) { t->fn(t->arg); }
+
+// Schedule fn(arg) as part of group g. Falls back to running it inline if the
+// task cannot be allocated.
+static inline void tp_spawn(struct tp_pool *pool, struct tp_group *g, tp_task_fn fn, void *arg) {
+    struct tp_task *t = (struct tp_task *)calloc(1, sizeof *t);
+    if (!t) { fn(arg); return; }
+    t->run = tp_run_plain;
+    t->group = g;
+    t->pool = pool;
+    t->fn = fn;
+    t->arg = arg;
+    tp_submit(pool, t);
+}
+
+// Block until every task in g has finished. The waiting thread executes
+// queued tasks instead of idling.
+static inline void tp_wait(struct tp_pool *pool, struct tp_group *g) {
+    struct tp_worker *w = tp_current(pool);
+    unsigned idle = 0;
+    while (__atomic_load_n(&g->pending, __ATOMIC_ACQUIRE) > 0) {
+        struct tp_task *t = tp_find_task(pool, w);
+        if (t) { tp_execute(t); idle = 0; continue; }
+        if (++idle < TP_SPIN) tp_relax();
+        else sched_yield();
+    }
+}
+
+// Lazy binary splitting: hand off the right half until the range fits the
+// grain, then run the left part here.
+static inline void tp_run_range(struct tp_task *t) {
+    size_t lo = t->lo, hi = t->hi;
+    while (hi - lo > t->grain) {
+        size_t mid = lo + (hi - lo) / 2;
+        struct tp_task *r = (struct tp_task *)malloc(sizeof *r);
+        if (!r) break;
+        *r = *t;
+        r->lo = mid;
+        r->hi = hi;
+        tp_submit(t->pool, r);
+        hi = mid;
+    }
+    t->body(lo, hi, t->arg);
+}
+
+// Default grain: about eight chunks per worker so stealing can balance load.
+static inline size_t tp_auto_grain(const struct tp_pool *pool, size_t n) {
+    size_t g = n / ((size_t)pool->nworkers * 8);
+    return g ? g : 1;
+}
+
+// Call body(lo, hi, ctx) over disjoint subranges covering [begin, end).
+// grain = 0 picks one automatically. Returns when all subranges are done.
+static inline void tp_parallel_for(struct tp_pool *pool, size_t begin, size_t end, size_t grain,
+                                   tp_range_fn body, void *ctx) {
+    if (end <= begin) return;
+    if (grain == 0) grain = tp_auto_grain(pool, end - begin);
+    struct tp_group g = TP_GROUP_INIT;
+    struct tp_task root;
+    memset(&root, 0, sizeof root);
+    root.run = tp_run_range;
+    root.group = &g;
+    root.pool = pool;
+    root.arg = ctx;
+    root.lo = begin;
+    root.hi = end;
+    root.grain = grain;
+    root.body = body;
+    tp_run_range(&root); // root lives on our stack; only its halves are queued
+    tp_wait(pool, &g);
+}
+
+struct tp_reduce_ctx {
+    size_t begin, end, grain, elem_size;
+    char *partials;
+    void (*map)(size_t lo, size_t hi, void *acc, void *ctx);
+    void *ctx;
+};
+
+static inline void tp_reduce_chunks(size_t lo, size_t hi, void *p) {
+    struct tp_reduce_ctx *rc = (struct tp_reduce_ctx *)p;
+    for (size_t c = lo; c < hi; ++c) {
+        size_t a = rc->begin + c * rc->grain;
+        size_t b = a + rc->grain < rc->end ? a + rc->grain : rc->end;
+        rc->map(a, b, rc->partials + c * rc->elem_size, rc->ctx);
+    }
+}
+
+// Reduce [begin, end) into *result. On entry *result holds the identity.
+// map folds a subrange into an accumulator; combine folds one accumulator
+// into another. Partials are combined in index order, so the result is
+// deterministic even for floating point.
+static inline bool tp_parallel_reduce(struct tp_pool *pool, size_t begin, size_t end, size_t grain,
+                                      void *result, size_t elem_size,
+                                      void (*map)(size_t lo, size_t hi, void *acc, void *ctx),
+                                      void (*combine)(void *acc, const void *other, void *ctx),
+                                      void *ctx) {
+    if (end <= begin) return true;
+    size_t n = end - begin;
+    if (grain == 0) grain = tp_auto_grain(pool, n);
+    size_t chunks = (n + grain - 1) / grain;
+    char *partials = (char *)malloc(chunks * elem_size);
+    if (!partials) return false;
+    for (size_t c = 0; c < chunks; ++c) memcpy(partials + c * elem_size, result, elem_size);
+
+    struct tp_reduce_ctx rc = { begin, end, grain, elem_size, partials, map, ctx };
+    tp_parallel_for(pool, 0, chunks, 1, tp_reduce_chunks, &rc);
+    for (size_t c = 0; c < chunks; ++c) combine(result, partials + c * elem_size, ctx);
+    free(partials);
+    return true;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+
+#include <new>
+#include <utility>
+#include <vector>
+
+// C++ wrapper. Callables must not throw: exceptions cannot cross the C
+// scheduler, so an escaping exception terminates the program.
+namespace tp {
+
+class Pool {
+public:
+    explicit Pool(unsigned nthreads = 0) : p_(tp_create(nthreads)) {
+        if (!p_) throw std::bad_alloc();
+    }
+    ~Pool() { tp_destroy(p_); }
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    unsigned size() const { return tp_size(p_); }
+    tp_pool *get() const { return p_; }
+
+    // f(size_t lo, size_t hi) over disjoint subranges of [begin, end)
+    template <class F>
+    void parallel_for(size_t begin, size_t end, F &&f, size_t grain = 0) {
+        tp_parallel_for(p_, begin, end, grain, &range_thunk<F>, (void *)&f);
+    }
+
+    // map(size_t lo, size_t hi, T acc) -> T, combine(T, T) -> T
+    template <class T, class Map, class Combine>
+    T parallel_reduce(size_t begin, size_t end, T identity, Map map, Combine combine,
+                      size_t grain = 0) {
+        if (end <= begin) return identity;
+        size_t n = end - begin;
+        if (grain == 0) grain = tp_auto_grain(p_, n);
+        size_t chunks = (n + grain - 1) / grain;
+        std::vector<T> partials(chunks, identity);
+        parallel_for(0, chunks, [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; ++c) {
+                size_t a = begin + c * grain;
+                size_t b = a + grain < end ? a + grain : end;
+                partials[c] = map(a, b, std::move(partials[c]));
+            }
+        }, 1);
+        T acc = std::move(identity);
+        for (auto &p : partials) acc = combine(std::move(acc), std::move(p));
+        return acc;
+    }
+
+private:
+    template <class F>
+    static void range_thunk(size_t lo, size_t hi, void *ctx) noexcept {
+        (*static_cast<typename std::remove_reference<F>::type *>(ctx))(lo, hi);
+    }
+
+    tp_pool *p_;
+};
+
+// Spawn heterogeneous tasks and wait for all of them; waits on destruction.
+class TaskGroup {
+public:
+    explicit TaskGroup(Pool &pool) : pool_(pool.get()) { g_.pending = 0; }
+    ~TaskGroup() { wait(); }
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    template <class F>
+    void run(F &&f) {
+        using Fn = typename std::decay<F>::type;
+        Fn *copy = new Fn(std::forward<F>(f));
+        tp_spawn(pool_, &g_, &task_thunk<Fn>, copy);
+    }
+
+    void wait() { tp_wait(pool_, &g_); }
+
+private:
+    template <class Fn>
+    static void task_thunk(void *p) noexcept {
+        Fn *f = static_cast<Fn *>(p);
+        (*f)();
+        delete f;
+    }
+
+    tp_pool *pool_;
+    tp_group g_;
+};
+
+} // namespace tp
+#endif // __cplusplus
+
+#endif // TPOOL_H
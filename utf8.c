@@ -0,0 +1,194 @@
+// Build: gcc -O2 utf8.c -o build/utf8
+// Usage: build/utf8 [MB]   (benchmark size per text sample, default 32)
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utf8.h"
+
+#define LEN(x) (sizeof(x)/sizeof((x)[0]))
+
+// The byte-at-a-time decoder the benchmark compares against.
+static bool validate_naive(const uint8_t *s, size_t n) {
+    uint32_t cp;
+    for (size_t i = 0, k; i < n; i += k)
+        if (!(k = utf8_decode_one(s + i, n - i, &cp))) return false;
+    return true;
+}
+
+// ---- Demos ----
+
+static void print_hex(const uint8_t *s, size_t n) {
+    for (size_t i = 0; i < n; ++i) printf("%02x ", s[i]);
+}
+
+static void basics_demo(void) {
+    const char *text = "na\xc3\xafve caf\xc3\xa9 \xe2\x82\xac 5 \xf0\x9f\x98\x80"; // "naïve café € 5 😀"
+    const uint8_t *s = (const uint8_t *)text;
+    size_t n = strlen(text);
+    printf("'%s': %zu bytes, %zu code points, ascii=%d, valid=%d\n", text, n, utf8_count(s, n),
+           utf8_is_ascii(s, n), utf8_validate(s, n));
+
+    uint32_t u32[64];
+    uint16_t u16[64];
+    uint8_t back[256];
+    size_t n32 = utf8_to_utf32(s, n, u32), n16 = utf8_to_utf16(s, n, u16);
+    printf("utf32 (%zu):", n32);
+    for (size_t i = 0; i < n32; ++i) printf(" U+%04X", u32[i]);
+    printf("\nutf16 (%zu units, the emoji is a surrogate pair: %04X %04X)\n", n16, u16[n16 - 2], u16[n16 - 1]);
+    size_t nb = utf16_to_utf8(u16, n16, back);
+    printf("utf16 -> utf8 round trip: %s\n", nb == n && memcmp(back, s, n) == 0 ? "ok" : "MISMATCH");
+
+    static const struct { const char *what; const char *bytes; } bad[] = {
+        {"overlong '/'", "\xc0\xaf"},
+        {"surrogate U+D800", "\xed\xa0\x80"},
+        {"above U+10FFFF", "\xf4\x90\x80\x80"},
+        {"truncated", "ok \xe2\x82"},
+        {"stray continuation", "\x80x"},
+    };
+    for (size_t i = 0; i < LEN(bad); ++i) {
+        const uint8_t *b = (const uint8_t *)bad[i].bytes;
+        printf("  %-20s ", bad[i].what);
+        print_hex(b, strlen(bad[i].bytes));
+        printf("-> %s\n", utf8_validate(b, strlen(bad[i].bytes)) ? "valid?!" : "rejected");
+    }
+    uint16_t lone[] = {'a', 0xdc00, 'b'};
+    printf("  lone low surrogate in utf16 -> %s\n", utf16_to_utf8(lone, LEN(lone), back) == UTF_ERR ? "rejected" : "accepted?!");
+}
+
+// ---- Fuzz against the scalar reference ----
+
+static uint64_t rng_state = 0x853c49e6748fea9bull;
+static uint64_t rng(void) {
+    uint64_t x = rng_state;
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return rng_state = x;
+}
+
+// Valid text mixing 1..4-byte sequences, weights chosen by mix (0 = ASCII only).
+static size_t gen_text(uint8_t *out, size_t n, int mix) {
+    static const uint32_t ranges[][2] = {{0x20, 0x7e}, {0xa0, 0x7ff}, {0x800, 0xd7ff}, {0xe000, 0xfffd}, {0x10000, 0x10ffff}};
+    size_t o = 0;
+    while (o + 4 <= n) {
+        unsigned r = (unsigned)(rng() % 100), k = 0;
+        if (mix == 1) k = r < 95 ? 0 : 1;                    // Latin text with accents
+        else if (mix == 2) k = r < 15 ? 0 : (r < 90 ? 2 : 3); // mostly CJK-width
+        else if (mix == 3) k = r < 40 ? 0 : (r < 60 ? 1 : (r < 80 ? 2 : 4)); // everything
+        uint32_t cp = ranges[k][0] + (uint32_t)(rng() % (ranges[k][1] - ranges[k][0] + 1));
+        o += utf8_encode_one(cp, out + o);
+    }
+    while (o < n) out[o++] = ' ';
+    return o;
+}
+
+static void fuzz(void) {
+    uint8_t buf[300], orig[300];
+    uint32_t u32[300];
+    uint16_t u16[600];
+    uint8_t back[1200];
+    long cases = 0, bad = 0, invalid = 0;
+    for (int iter = 0; iter < 200000; ++iter) {
+        size_t n = (size_t)(rng() % 260);
+        gen_text(buf, n, (int)(rng() % 4));
+        memcpy(orig, buf, n);
+        int muts = iter % 3 == 0 ? 0 : (int)(rng() % 4);
+        for (int m = 0; m < muts && n; ++m) {
+            size_t at = (size_t)(rng() % n);
+            switch (rng() % 4) {
+                case 0: buf[at] = (uint8_t)rng(); break;
+                case 1: buf[at] ^= (uint8_t)(1u << (rng() % 8)); break;
+                case 2: buf[at] = (uint8_t)(0x80 | (rng() & 0x3f)); break;
+                default: buf[at] = (uint8_t)(0xc0 | (rng() & 0x3f)); break;
+            }
+        }
+        bool want = validate_naive(buf, n);
+        invalid += !want;
+        bad += utf8_validate(buf, n) != want || utf8_validate_scalar(buf, n) != want;
+        size_t m32 = utf8_to_utf32(buf, n, u32), m16 = utf8_to_utf16(buf, n, u16);
+        if (!want) {
+            bad += m32 != UTF_ERR || m16 != UTF_ERR;
+        } else {
+            bad += m32 != utf8_count(buf, n);
+            size_t b32 = utf32_to_utf8(u32, m32, back);
+            bad += b32 != n || memcmp(back, buf, n) != 0;
+            size_t b16 = utf16_to_utf8(u16, m16, back);
+            bad += b16 != n || memcmp(back, buf, n) != 0;
+            bad += utf8_is_ascii(buf, n) != utf8_is_ascii_scalar(buf, n);
+        }
+        ++cases;
+    }
+    printf("fuzz: %ld inputs (%ld invalid) vs scalar decoder: %s\n", cases, invalid, bad ? "MISMATCH" : "ok");
+}
+
+// ---- Benchmark ----
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench(size_t n) {
+    uint8_t *s = malloc(n), *back = malloc(n);
+    uint32_t *u32 = malloc(n * sizeof *u32);
+    uint16_t *u16 = malloc(n * sizeof *u16);
+    if (!s || !back || !u32 || !u16) { perror("malloc"); goto out; }
+    // Fault the output pages in now, not inside the first timed column
+    memset(back, 0, n);
+    memset(u32, 0, n * sizeof *u32);
+    memset(u16, 0, n * sizeof *u16);
+    static const char *names[] = {"ascii", "latin", "cjk", "mixed"};
+    printf("%-6s %9s %9s %9s %9s %9s %9s  GB/s of UTF-8\n", "text", "naive", "validate", "count", "->utf32", "->utf16", "utf16->");
+    for (int mix = 0; mix < 4; ++mix) {
+        gen_text(s, n, mix);
+        const int reps = 3;
+        double gb = (double)n * reps / 1e9, t0, t[6];
+        bool ok = true;
+        size_t c = 0, m32 = 0, m16 = 0, mb = 0;
+
+        t0 = now_sec();
+        for (int r = 0; r < reps; ++r) ok &= validate_naive(s, n);
+        t[0] = now_sec() - t0;
+        t0 = now_sec();
+        for (int r = 0; r < reps; ++r) ok &= utf8_validate(s, n);
+        t[1] = now_sec() - t0;
+        t0 = now_sec();
+        for (int r = 0; r < reps; ++r) c = utf8_count(s, n);
+        t[2] = now_sec() - t0;
+        t0 = now_sec();
+        for (int r = 0; r < reps; ++r) m32 = utf8_to_utf32(s, n, u32);
+        t[3] = now_sec() - t0;
+        t0 = now_sec();
+        for (int r = 0; r < reps; ++r) m16 = utf8_to_utf16(s, n, u16);
+        t[4] = now_sec() - t0;
+        t0 = now_sec();
+        for (int r = 0; r < reps; ++r) mb = utf16_to_utf8(u16, m16, back);
+        t[5] = now_sec() - t0;
+        ok &= m32 == c && mb == n && memcmp(back, s, n) == 0;
+
+        printf("%-6s", names[mix]);
+        for (int k = 0; k < 6; ++k) printf(" %9.2f", gb / t[k]);
+        printf("  %s\n", ok ? "ok" : "MISMATCH");
+    }
+out:
+    free(s); free(back); free(u32); free(u16);
+}
+
+int main(int argc, char **argv) {
+    utf8_kernels_init();
+    size_t mb = argc > 1 ? strtoul(argv[1], NULL, 10) : 32;
+    if (!mb) mb = 32;
+
+    puts("-- UTF-8 --");
+    basics_demo();
+
+    puts("\n-- UTF-8: fuzz --");
+    fuzz();
+
+    printf("\n-- UTF-8: benchmark, %zu MB per sample (level %s) --\n", mb, cpu_level_name(cpu_info()->level));
+    bench(mb << 20);
+    return 0;
+}
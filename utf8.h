@@ -0,0 +1,770 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+// UTF-8 text routines that work on bytes and code points only, never on the
+// C locale, so they behave the same whatever setlocale() did (locale_demo).
+//
+//   utf8_validate    well-formed per RFC 3629: no overlongs, surrogates,
+//                    code points above U+10FFFF or truncated sequences
+//   utf8_is_ascii    all bytes < 0x80
+//   utf8_count       code points in valid UTF-8
+//   utf8_to_utf16/32, utf16/32_to_utf8
+//                    validating transcoders; UTF-16/UTF-32 output is in
+//                    host byte order
+//
+// The AVX2 validator is the Keiser-Lemire lookup algorithm: three 16-entry
+// nibble tables classify every (previous byte, byte) pair into error bits,
+// and a separate check enforces the continuation count after 3- and 4-byte
+// leads. Transcoders hand ASCII stretches of at least 32 bytes to a vector
+// kernel. From UTF-8 they check and decode one code point at a time; when
+// the validator is vectorized, blocks where ASCII and other code points
+// alternate are validated first and decoded branch-free instead, finding
+// code point starts from byte-class masks.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "cpuprobe.h"
+#ifdef CPU_X86
+#include <immintrin.h>
+#endif
+
+#define UTF_ERR ((size_t)-1)
+
+// ---- Scalar reference ----
+
+// Decode one code point from s[0..n); returns its length, or 0 if invalid.
+static inline size_t utf8_decode_one(const uint8_t *s, size_t n, uint32_t *cp) {
+    uint8_t c = s[0];
+    if (c < 0x80) { *cp = c; return 1; }
+    if (c < 0xc2) return 0; // continuation byte or overlong 2-byte lead
+    if (c < 0xe0) {
+        if (n < 2 || (s[1] & 0xc0) != 0x80) return 0;
+        *cp = (uint32_t)(c & 0x1f) << 6 | (s[1] & 0x3f);
+        return 2;
+    }
+    if (c < 0xf0) {
+        if (n < 3 || (s[1] & 0xc0) != 0x80 || (s[2] & 0xc0) != 0x80) return 0;
+        uint32_t v = (uint32_t)(c & 0x0f) << 12 | (uint32_t)(s[1] & 0x3f) << 6 | (s[2] & 0x3f);
+        if (v < 0x800 || (v >= 0xd800 && v <= 0xdfff)) return 0;
+        *cp = v;
+        return 3;
+    }
+    if (c < 0xf5) {
+        if (n < 4 || (s[1] & 0xc0) != 0x80 || (s[2] & 0xc0) != 0x80 || (s[3] & 0xc0) != 0x80) return 0;
+        uint32_t v = (uint32_t)(c & 0x07) << 18 | (uint32_t)(s[1] & 0x3f) << 12 |
+                     (uint32_t)(s[2] & 0x3f) << 6 | (s[3] & 0x3f);
+        if (v < 0x10000 || v > 0x10ffff) return 0;
+        *cp = v;
+        return 4;
+    }
+    return 0;
+}
+
+static inline size_t utf8_encode_one(uint32_t cp, uint8_t *out) {
+    if (cp < 0x80) { out[0] = (uint8_t)cp; return 1; }
+    if (cp < 0x800) {
+        out[0] = (uint8_t)(0xc0 | cp >> 6);
+        out[1] = (uint8_t)(0x80 | (cp & 0x3f));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (uint8_t)(0xe0 | cp >> 12);
+        out[1] = (uint8_t)(0x80 | (cp >> 6 & 0x3f));
+        out[2] = (uint8_t)(0x80 | (cp & 0x3f));
+        return 3;
+    }
+    out[0] = (uint8_t)(0xf0 | cp >> 18);
+    out[1] = (uint8_t)(0x80 | (cp >> 12 & 0x3f));
+    out[2] = (uint8_t)(0x80 | (cp >> 6 & 0x3f));
+    out[3] = (uint8_t)(0x80 | (cp & 0x3f));
+    return 4;
+}
+
+static inline bool utf8_word_is_ascii(const uint8_t *s) {
+    uint64_t w;
+    memcpy(&w, s, 8);
+    return (w & 0x8080808080808080ull) == 0;
+}
+
+// Skips ASCII 8 bytes at a time, decodes the rest one code point at a time.
+static inline bool utf8_validate_scalar(const uint8_t *s, size_t n) {
+    size_t i = 0;
+    uint32_t cp;
+    while (i < n) {
+        if (i + 8 <= n && utf8_word_is_ascii(s + i)) { i += 8; continue; }
+        size_t k = utf8_decode_one(s + i, n - i, &cp);
+        if (!k) return false;
+        i += k;
+    }
+    return true;
+}
+
+static inline bool utf8_is_ascii_scalar(const uint8_t *s, size_t n) {
+    size_t i = 0;
+    uint64_t acc = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, s + i, 8);
+        acc |= w;
+    }
+    for (; i < n; ++i) acc |= s[i];
+    return (acc & 0x8080808080808080ull) == 0;
+}
+
+// Every byte that is not a continuation (10xxxxxx) starts a code point.
+static inline size_t utf8_count_scalar(const uint8_t *s, size_t n) {
+    size_t c = 0;
+    for (size_t i = 0; i < n; ++i) c += (int8_t)s[i] > -65;
+    return c;
+}
+
+// ASCII runs for the transcoders: convert the leading ASCII bytes of
+// s[0..n) and return how many were consumed.
+static inline size_t utf8_ascii_to_u32_scalar(const uint8_t *s, size_t n, uint32_t *out) {
+    size_t i = 0;
+    while (i + 8 <= n && utf8_word_is_ascii(s + i)) {
+        for (int j = 0; j < 8; ++j) out[i + j] = s[i + j];
+        i += 8;
+    }
+    while (i < n && s[i] < 0x80) { out[i] = s[i]; ++i; }
+    return i;
+}
+
+static inline size_t utf8_ascii_to_u16_scalar(const uint8_t *s, size_t n, uint16_t *out) {
+    size_t i = 0;
+    while (i + 8 <= n && utf8_word_is_ascii(s + i)) {
+        for (int j = 0; j < 8; ++j) out[i + j] = s[i + j];
+        i += 8;
+    }
+    while (i < n && s[i] < 0x80) { out[i] = s[i]; ++i; }
+    return i;
+}
+
+static inline size_t utf8_u16_to_ascii_scalar(const uint16_t *s, size_t n, uint8_t *out) {
+    size_t i = 0;
+    while (i < n && s[i] < 0x80) { out[i] = (uint8_t)s[i]; ++i; }
+    return i;
+}
+
+// ---- AVX2 ----
+#ifdef CPU_X86
+
+// Error bits for a (previous byte, byte) pair, see utf8_special_cases
+#define UTF8_TOO_SHORT      (1 << 0) // lead followed by ASCII or another lead
+#define UTF8_TOO_LONG       (1 << 1) // ASCII followed by continuation
+#define UTF8_OVERLONG_3     (1 << 2) // E0 80..9F
+#define UTF8_TOO_LARGE      (1 << 3) // F4 90..BF, F5..FF
+#define UTF8_SURROGATE      (1 << 4) // ED A0..BF
+#define UTF8_OVERLONG_2     (1 << 5) // C0..C1 xx
+#define UTF8_TOO_LARGE_1000 (1 << 6) // F5..FF 80..8F
+#define UTF8_OVERLONG_4     (1 << 6) // F0 80..8F
+#define UTF8_TWO_CONTS      (1 << 7) // continuation after continuation (checked again by length)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+// The 32 bytes ending n bytes before `input`: prev's tail followed by input.
+#define UTF8_PREV(input, prev, n) \
+    _mm256_alignr_epi8((input), _mm256_permute2x128_si256((prev), (input), 0x21), 16 - (n))
+
+CPU_TARGET_AVX2
+static inline __m256i utf8_table(__m256i idx, char a0, char a1, char a2, char a3, char a4, char a5, char a6, char a7,
+                                 char a8, char a9, char a10, char a11, char a12, char a13, char a14, char a15) {
+    __m256i t = _mm256_setr_epi8(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15,
+                                 a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15);
+    return _mm256_shuffle_epi8(t, idx);
+}
+
+CPU_TARGET_AVX2
+static inline __m256i utf8_hi_nibble(__m256i v) { return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f)); }
+
+// Each table maps one nibble to the errors it allows; an error is real only
+// when all three nibbles agree, so the tables are ANDed.
+CPU_TARGET_AVX2
+static inline __m256i utf8_special_cases(__m256i input, __m256i prev1) {
+    const char TS = UTF8_TOO_SHORT, TL = UTF8_TOO_LONG, O3 = UTF8_OVERLONG_3, LG = UTF8_TOO_LARGE,
+               SG = UTF8_SURROGATE, O2 = UTF8_OVERLONG_2, L1 = UTF8_TOO_LARGE_1000, O4 = UTF8_OVERLONG_4,
+               TC = (char)UTF8_TWO_CONTS, CA = (char)UTF8_CARRY;
+    __m256i byte_1_high = utf8_table(utf8_hi_nibble(prev1),
+        TL, TL, TL, TL, TL, TL, TL, TL,           // 0xxx: ASCII
+        TC, TC, TC, TC,                           // 10xx: continuation
+        TS | O2,                                  // 1100
+        TS,                                       // 1101
+        TS | O3 | SG,                             // 1110
+        TS | LG | L1 | O4);                       // 1111
+    __m256i byte_1_low = utf8_table(_mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)),
+        CA | O3 | O2 | O4,                        // xxxx0000
+        CA | O2,                                  // xxxx0001
+        CA, CA,
+        CA | LG,                                  // xxxx0100
+        CA | LG | L1, CA | LG | L1, CA | LG | L1, // xxxx0101..0111
+        CA | LG | L1, CA | LG | L1, CA | LG | L1, CA | LG | L1, CA | LG | L1,
+        CA | LG | L1 | SG,                        // xxxx1101
+        CA | LG | L1, CA | LG | L1);
+    __m256i byte_2_high = utf8_table(utf8_hi_nibble(input),
+        TS, TS, TS, TS, TS, TS, TS, TS,           // ASCII
+        TL | O2 | TC | O3 | L1 | O4,              // 1000
+        TL | O2 | TC | O3 | LG,                   // 1001
+        TL | O2 | TC | SG | LG,                   // 1010
+        TL | O2 | TC | SG | LG,                   // 1011
+        TS, TS, TS, TS);                          // lead byte
+    return _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+}
+
+// Bytes 2 and 3 after a 3-/4-byte lead must be continuations: those are
+// exactly the TWO_CONTS positions that are allowed, so xor flips them.
+CPU_TARGET_AVX2
+static inline __m256i utf8_multibyte_lengths(__m256i input, __m256i prev_input, __m256i sc) {
+    __m256i prev2 = UTF8_PREV(input, prev_input, 2);
+    __m256i prev3 = UTF8_PREV(input, prev_input, 3);
+    __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80))); // >= 0x80 only for 111xxxxx
+    __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80))); // only for 1111xxxx
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must23, sc);
+}
+
+// Non-zero where the block ends inside a sequence that needs more bytes.
+CPU_TARGET_AVX2
+static inline __m256i utf8_incomplete(__m256i input) {
+    const __m256i max = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                         -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                         (char)(0xf0 - 1), (char)(0xe0 - 1), (char)(0xc0 - 1));
+    return _mm256_subs_epu8(input, max);
+}
+
+CPU_TARGET_AVX2
+static inline bool utf8_validate_avx2(const uint8_t *s, size_t n) {
+    __m256i err = _mm256_setzero_si256(), prev_input = _mm256_setzero_si256(), prev_incomplete = err;
+    size_t i = 0;
+    for (;; i += 32) {
+        __m256i input;
+        if (i + 32 <= n) {
+            input = _mm256_loadu_si256((const __m256i *)(s + i));
+        } else {
+            if (i >= n) break;
+            uint8_t tail[32] = {0}; // zero padding is ASCII
+            memcpy(tail, s + i, n - i);
+            input = _mm256_loadu_si256((const __m256i *)tail);
+        }
+        if (_mm256_movemask_epi8(input) == 0) {
+            err = _mm256_or_si256(err, prev_incomplete);
+        } else {
+            __m256i prev1 = UTF8_PREV(input, prev_input, 1);
+            __m256i sc = utf8_special_cases(input, prev1);
+            err = _mm256_or_si256(err, utf8_multibyte_lengths(input, prev_input, sc));
+            prev_incomplete = utf8_incomplete(input);
+        }
+        prev_input = input;
+        if (i + 32 >= n) { i += 32; break; }
+    }
+    err = _mm256_or_si256(err, prev_incomplete);
+    return _mm256_testz_si256(err, err);
+}
+
+CPU_TARGET_AVX2
+static inline bool utf8_is_ascii_avx2(const uint8_t *s, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i *)(s + i)));
+    return _mm256_movemask_epi8(acc) == 0 && utf8_is_ascii_scalar(s + i, n - i);
+}
+
+CPU_TARGET_AVX2
+static inline size_t utf8_count_avx2(const uint8_t *s, size_t n) {
+    const __m256i cont = _mm256_set1_epi8(-65); // bytes > -65 as int8 are not 10xxxxxx
+    size_t c = 0, i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i lead = _mm256_cmpgt_epi8(_mm256_loadu_si256((const __m256i *)(s + i)), cont);
+        c += (size_t)__builtin_popcount((unsigned)_mm256_movemask_epi8(lead));
+    }
+    return c + utf8_count_scalar(s + i, n - i);
+}
+
+CPU_TARGET_AVX2
+static inline size_t utf8_ascii_to_u32_avx2(const uint8_t *s, size_t n, uint32_t *out) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(v);
+        if (mask) {
+            size_t k = (size_t)__builtin_ctz(mask);
+            for (size_t j = 0; j < k; ++j) out[i + j] = s[i + j];
+            return i + k;
+        }
+        __m128i lo = _mm256_castsi256_si128(v), hi = _mm256_extracti128_si256(v, 1);
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_cvtepu8_epi32(lo));
+        _mm256_storeu_si256((__m256i *)(out + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+        _mm256_storeu_si256((__m256i *)(out + i + 16), _mm256_cvtepu8_epi32(hi));
+        _mm256_storeu_si256((__m256i *)(out + i + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+    }
+    return i + utf8_ascii_to_u32_scalar(s + i, n - i, out + i);
+}
+
+CPU_TARGET_AVX2
+static inline size_t utf8_ascii_to_u16_avx2(const uint8_t *s, size_t n, uint16_t *out) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(v);
+        if (mask) {
+            size_t k = (size_t)__builtin_ctz(mask);
+            for (size_t j = 0; j < k; ++j) out[i + j] = s[i + j];
+            return i + k;
+        }
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+        _mm256_storeu_si256((__m256i *)(out + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+    }
+    return i + utf8_ascii_to_u16_scalar(s + i, n - i, out + i);
+}
+
+CPU_TARGET_AVX2
+static inline size_t utf8_u16_to_ascii_avx2(const uint16_t *s, size_t n, uint8_t *out) {
+    const __m256i high = _mm256_set1_epi16((short)0xff80);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(s + i + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), high)) break;
+        // packus interleaves 128-bit lanes; permute puts them back in order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256((__m256i *)(out + i), packed);
+    }
+    return i + utf8_u16_to_ascii_scalar(s + i, n - i, out + i);
+}
+#endif
+
+// ---- Dispatch, resolved once ----
+
+typedef bool (*utf8_check_fn)(const uint8_t *, size_t);
+typedef size_t (*utf8_count_fn)(const uint8_t *, size_t);
+typedef size_t (*utf8_ascii_u32_fn)(const uint8_t *, size_t, uint32_t *);
+typedef size_t (*utf8_ascii_u16_fn)(const uint8_t *, size_t, uint16_t *);
+typedef size_t (*utf8_u16_ascii_fn)(const uint16_t *, size_t, uint8_t *);
+
+// Positional, so C++ can include this header too.
+static const utf8_check_fn utf8_validate_table[CPU_LEVEL_COUNT] = {
+    utf8_validate_scalar,         // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                         // CPU_LEVEL_SSE42
+    utf8_validate_avx2,           // CPU_LEVEL_AVX2
+#endif
+};
+static const utf8_check_fn utf8_is_ascii_table[CPU_LEVEL_COUNT] = {
+    utf8_is_ascii_scalar,         // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                         // CPU_LEVEL_SSE42
+    utf8_is_ascii_avx2,           // CPU_LEVEL_AVX2
+#endif
+};
+static const utf8_count_fn utf8_count_table[CPU_LEVEL_COUNT] = {
+    utf8_count_scalar,            // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                         // CPU_LEVEL_SSE42
+    utf8_count_avx2,              // CPU_LEVEL_AVX2
+#endif
+};
+static const utf8_ascii_u32_fn utf8_ascii_u32_table[CPU_LEVEL_COUNT] = {
+    utf8_ascii_to_u32_scalar,     // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                         // CPU_LEVEL_SSE42
+    utf8_ascii_to_u32_avx2,       // CPU_LEVEL_AVX2
+#endif
+};
+static const utf8_ascii_u16_fn utf8_ascii_u16_table[CPU_LEVEL_COUNT] = {
+    utf8_ascii_to_u16_scalar,     // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                         // CPU_LEVEL_SSE42
+    utf8_ascii_to_u16_avx2,       // CPU_LEVEL_AVX2
+#endif
+};
+static const utf8_u16_ascii_fn utf8_u16_ascii_table[CPU_LEVEL_COUNT] = {
+    utf8_u16_to_ascii_scalar,     // CPU_LEVEL_SCALAR
+#ifdef CPU_X86
+    NULL,                         // CPU_LEVEL_SSE42
+    utf8_u16_to_ascii_avx2,       // CPU_LEVEL_AVX2
+#endif
+};
+
+// Scalar kernels until utf8_kernels_init() has run.
+static utf8_check_fn utf8_validate = utf8_validate_scalar;
+static utf8_check_fn utf8_is_ascii = utf8_is_ascii_scalar;
+static utf8_count_fn utf8_count = utf8_count_scalar;   // code points; input must be valid UTF-8
+static utf8_ascii_u32_fn utf8_ascii_to_u32 = utf8_ascii_to_u32_scalar;
+static utf8_ascii_u16_fn utf8_ascii_to_u16 = utf8_ascii_to_u16_scalar;
+static utf8_u16_ascii_fn utf8_u16_to_ascii = utf8_u16_to_ascii_scalar;
+static bool utf8_validate_fast; // vector validator: transcoders validate first
+
+static inline void utf8_kernels_init(void) {
+    CPU_DISPATCH(utf8_validate, utf8_validate_table);
+    CPU_DISPATCH(utf8_is_ascii, utf8_is_ascii_table);
+    CPU_DISPATCH(utf8_count, utf8_count_table);
+    CPU_DISPATCH(utf8_ascii_to_u32, utf8_ascii_u32_table);
+    CPU_DISPATCH(utf8_ascii_to_u16, utf8_ascii_u16_table);
+    CPU_DISPATCH(utf8_u16_to_ascii, utf8_u16_ascii_table);
+    utf8_validate_fast = utf8_validate != utf8_validate_scalar;
+}
+
+// ---- Transcoding ----
+// Each returns the number of output units written, or UTF_ERR if the input
+// is not valid. Output sizes: UTF-32/UTF-16 need at most n units for n UTF-8
+// bytes; UTF-8 needs at most 3 bytes per UTF-16 unit, 4 per UTF-32 unit.
+
+// The ASCII kernels are an indirect call; in mixed text, where ASCII comes in
+// short words between other code points, they only pay off when a whole
+// vector of input is ASCII. Shorter runs stay in the scalar loop.
+static inline bool utf8_ascii_ahead_u8(const uint8_t *s, size_t n) {
+    if (n < 32) return false;
+#ifdef CPU_X86
+    return !_mm_movemask_epi8(_mm_or_si128(_mm_loadu_si128((const __m128i *)s), _mm_loadu_si128((const __m128i *)(s + 16))));
+#else
+    uint64_t w0, w1, w2, w3;
+    memcpy(&w0, s, 8);
+    memcpy(&w1, s + 8, 8);
+    memcpy(&w2, s + 16, 8);
+    memcpy(&w3, s + 24, 8);
+    return !((w0 | w1 | w2 | w3) & 0x8080808080808080ull);
+#endif
+}
+
+static inline bool utf8_ascii_ahead_u16(const uint16_t *s, size_t n) {
+    uint64_t w[4];
+    if (n < sizeof w / 2) return false;
+    memcpy(w, s, sizeof w);
+    return !((w[0] | w[1] | w[2] | w[3]) & 0xff80ff80ff80ff80ull);
+}
+
+// Decode one code point of already validated input without branches (mixed
+// text makes the per-length branches of utf8_decode_one unpredictable).
+// The 4 bytes at s are read big-end first, masked down to their payload
+// bits for the length the lead byte implies, squeezed together and shifted
+// right over the bytes past the code point.
+static inline void utf8_decode_valid(const uint8_t *s, uint32_t *cp) {
+    static const uint32_t keep[16] = {
+        0x7f000000, 0x7f000000, 0x7f000000, 0x7f000000, 0x7f000000, 0x7f000000, 0x7f000000, 0x7f000000,
+        0, 0, 0, 0, 0x1f3f0000, 0x1f3f0000, 0x0f3f3f00, 0x073f3f3f};
+    static const uint8_t shift[16] = {18, 18, 18, 18, 18, 18, 18, 18, 0, 0, 0, 0, 12, 12, 6, 0};
+    uint32_t x;
+    memcpy(&x, s, sizeof x);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    x = __builtin_bswap32(x);
+#endif
+    x &= keep[s[0] >> 4];
+    x = (x & 0x003f003f) | (x & 0x7f003f00) >> 2;
+    x = (x & 0x00000fff) | (x & 0x1fff0000) >> 4;
+    *cp = x >> shift[s[0] >> 4];
+}
+
+#ifndef CPU_X86
+// Top bits of the 8 bytes at s, packed with s[0]'s lowest.
+static inline unsigned utf8_top_bits8(const uint8_t *s) {
+    uint64_t w;
+    memcpy(&w, s, sizeof w);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    return (unsigned)(((w & 0x8080808080808080ull) >> 7) * 0x0102040810204080ull >> 56);
+}
+#endif
+
+// One bit per byte of the 32 at s (s[0] lowest): non-ASCII bytes in *hi,
+// continuation bytes (10xxxxxx) in *cont.
+static inline void utf8_byte_classes32(const uint8_t *s, uint32_t *hi, uint32_t *cont) {
+#ifdef CPU_X86
+    __m128i a = _mm_loadu_si128((const __m128i *)s), b = _mm_loadu_si128((const __m128i *)(s + 16));
+    __m128i c0 = _mm_set1_epi8((char)0xc0);
+    *hi = (uint32_t)_mm_movemask_epi8(a) | (uint32_t)_mm_movemask_epi8(b) << 16;
+    *cont = (uint32_t)_mm_movemask_epi8(_mm_cmplt_epi8(a, c0)) | (uint32_t)_mm_movemask_epi8(_mm_cmplt_epi8(b, c0)) << 16;
+#else
+    uint8_t b6[32];
+    for (size_t j = 0; j < 32; j++) b6[j] = (uint8_t)(s[j] << 1);
+    *hi = *cont = 0;
+    for (size_t j = 0; j < 32; j += 8) {
+        *hi |= (uint32_t)utf8_top_bits8(s + j) << j;
+        *cont |= (uint32_t)(utf8_top_bits8(s + j) & ~utf8_top_bits8(b6 + j)) << j;
+    }
+#endif
+}
+
+// Plan one step from s, a code point boundary, after the caller has widened
+// the 16 bytes there: the leading ASCII bytes are kept (o moves past them),
+// m gets the starts of the code points in the non-ASCII run after them, and
+// the step ends where that run does, or at the first code point boundary
+// from byte 16 on. Every ASCII byte is thus widened rather than decoded, and
+// the step length comes from the byte classes alone, so the next step does
+// not wait on decoding. *m4, if asked for, gets the starts of 4-byte code
+// points among m. Returns the bytes consumed (16 if all are ASCII).
+static inline size_t utf8_step(const uint8_t *s, size_t *o, uint32_t *m, uint32_t *m4) {
+    uint32_t hi, cont;
+    utf8_byte_classes32(s, &hi, &cont);
+    unsigned first = (unsigned)__builtin_ctz(hi | 1u << 16);
+    unsigned end = (unsigned)__builtin_ctz((~hi & ~0u << first) | 1u << 31);
+    unsigned cap = (unsigned)__builtin_ctz(~cont & 0xffff0000u);
+    unsigned adv = end < cap ? end : cap;
+    *o += first;
+    *m = hi & ~cont & ((1u << adv) - 1);
+    if (m4) *m4 = *m & cont >> 1 & cont >> 2 & cont >> 3;
+    return adv;
+}
+
+// Widen 16 bytes to output units; callers keep only the leading ASCII ones.
+static inline void utf8_widen16_u32(const uint8_t *s, uint32_t *out) {
+#ifdef CPU_X86
+    __m128i b = _mm_loadu_si128((const __m128i *)s), z = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(b, z), hi = _mm_unpackhi_epi8(b, z);
+    _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(lo, z));
+    _mm_storeu_si128((__m128i *)(out + 4), _mm_unpackhi_epi16(lo, z));
+    _mm_storeu_si128((__m128i *)(out + 8), _mm_unpacklo_epi16(hi, z));
+    _mm_storeu_si128((__m128i *)(out + 12), _mm_unpackhi_epi16(hi, z));
+#else
+    for (size_t j = 0; j < 16; j++) out[j] = s[j];
+#endif
+}
+
+static inline void utf8_widen16_u16(const uint8_t *s, uint16_t *out) {
+#ifdef CPU_X86
+    __m128i b = _mm_loadu_si128((const __m128i *)s), z = _mm_setzero_si128();
+    _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(b, z));
+    _mm_storeu_si128((__m128i *)(out + 8), _mm_unpackhi_epi8(b, z));
+#else
+    for (size_t j = 0; j < 16; j++) out[j] = s[j];
+#endif
+}
+
+// Store cp as one unit or a surrogate pair without branching; always writes
+// two units and returns how many count.
+static inline size_t utf16_put(uint32_t cp, uint16_t *out) {
+    uint32_t big = cp >= 0x10000, v = cp - 0x10000;
+    out[0] = (uint16_t)(big ? 0xd800 | v >> 10 : cp);
+    out[1] = (uint16_t)(0xdc00 | (v & 0x3ff));
+    return 1 + big;
+}
+
+// Decode s[i..end) one code point at a time, checking each as it goes; end
+// is n or the start of a code point. With wide, runs of two or more ASCII
+// bytes are widened 16 at a time, or go to the ASCII kernel when a whole
+// vector is ASCII, instead of being copied byte by byte (a net loss when
+// most runs are one byte long, as between CJK characters). Returns where it
+// stopped, at or past end (the ASCII kernel does not stop there), or UTF_ERR.
+static inline size_t utf8_run_u32(const uint8_t *s, size_t n, size_t i, size_t end, bool wide,
+                                  uint32_t *out, size_t *po) {
+    size_t o = *po;
+    while (i < end) {
+        if (s[i] >= 0x80) {
+            size_t k = utf8_decode_one(s + i, n - i, &out[o]);
+            if (!k) return UTF_ERR;
+            i += k;
+            ++o;
+        } else if (wide && n - i >= 32 && s[i + 1] < 0x80) {
+            uint32_t hi, cont;
+            utf8_byte_classes32(s + i, &hi, &cont);
+            size_t k = hi ? (size_t)__builtin_ctz(hi) : utf8_ascii_to_u32(s + i, n - i, out + o);
+            if (hi) {
+                utf8_widen16_u32(s + i, out + o);
+                if (k > 16) utf8_widen16_u32(s + i + 16, out + o + 16);
+            }
+            i += k;
+            o += k;
+        } else {
+            out[o++] = s[i++];
+        }
+    }
+    *po = o;
+    return i;
+}
+
+static inline size_t utf8_run_u16(const uint8_t *s, size_t n, size_t i, size_t end, bool wide,
+                                  uint16_t *out, size_t *po) {
+    size_t o = *po;
+    while (i < end) {
+        if (s[i] >= 0x80) {
+            uint32_t cp;
+            size_t k = utf8_decode_one(s + i, n - i, &cp);
+            if (!k) return UTF_ERR;
+            i += k;
+            if (cp < 0x10000) {
+                out[o++] = (uint16_t)cp;
+            } else {
+                cp -= 0x10000;
+                out[o++] = (uint16_t)(0xd800 | cp >> 10);
+                out[o++] = (uint16_t)(0xdc00 | (cp & 0x3ff));
+            }
+        } else if (wide && n - i >= 32 && s[i + 1] < 0x80) {
+            uint32_t hi, cont;
+            utf8_byte_classes32(s + i, &hi, &cont);
+            size_t k = hi ? (size_t)__builtin_ctz(hi) : utf8_ascii_to_u16(s + i, n - i, out + o);
+            if (hi) {
+                utf8_widen16_u16(s + i, out + o);
+                if (k > 16) utf8_widen16_u16(s + i + 16, out + o + 16);
+            }
+            i += k;
+            o += k;
+        } else {
+            out[o++] = (uint16_t)s[i++];
+        }
+    }
+    *po = o;
+    return i;
+}
+
+// The plain loop, one copy shared by both paths below (unused: not every
+// includer transcodes).
+__attribute__((noinline, unused))
+static size_t utf8_checked_u32(const uint8_t *s, size_t n, size_t i, size_t end, uint32_t *out, size_t *po) {
+    return utf8_run_u32(s, n, i, end, false, out, po);
+}
+
+__attribute__((noinline, unused))
+static size_t utf8_checked_u16(const uint8_t *s, size_t n, size_t i, size_t end, uint16_t *out, size_t *po) {
+    return utf8_run_u16(s, n, i, end, false, out, po);
+}
+
+// Without a vector validator, validating first would cost as much as the
+// decode itself; the scalar level decodes and checks in one pass instead.
+static inline size_t utf8_to_utf32_checked(const uint8_t *s, size_t n, uint32_t *out) {
+    size_t o = 0;
+    return utf8_checked_u32(s, n, 0, n, out, &o) == UTF_ERR ? UTF_ERR : o;
+}
+
+static inline size_t utf8_to_utf16_checked(const uint8_t *s, size_t n, uint16_t *out) {
+    size_t o = 0;
+    return utf8_checked_u16(s, n, 0, n, out, &o) == UTF_ERR ? UTF_ERR : o;
+}
+
+// With one, the input goes in blocks of about UTF8_BLOCK bytes, each decoded
+// the way that suits its first UTF8_SAMPLE bytes:
+//   UTF8_MIXED   ASCII and other code points alternate often, so the checked
+//                loop's branches mispredict: validate the block, then go
+//                through it in branch-free utf8_step()s
+//   UTF8_ASCIIY  mostly ASCII: checked loop, widening ASCII runs
+//   UTF8_OTHER   checked loop as is (e.g. CJK with the odd ASCII byte)
+#define UTF8_BLOCK 4096
+#define UTF8_SAMPLE 512
+
+enum utf8_kind { UTF8_OTHER, UTF8_ASCIIY, UTF8_MIXED };
+
+static inline enum utf8_kind utf8_sample(const uint8_t *s, size_t n) {
+    unsigned switches = 0, cps = 0, ascii = 0;
+    uint32_t carry = 0;
+    for (size_t j = 0; j + 32 <= n; j += 32) {
+        uint32_t hi, cont;
+        utf8_byte_classes32(s + j, &hi, &cont);
+        switches += (unsigned)__builtin_popcount(hi ^ (hi << 1 | carry));
+        carry = hi >> 31;
+        cps += 32 - (unsigned)__builtin_popcount(cont);
+        ascii += 32 - (unsigned)__builtin_popcount(hi);
+    }
+    if (8 * switches >= 3 * cps && cps) return UTF8_MIXED;
+    return 2 * ascii >= cps && cps ? UTF8_ASCIIY : UTF8_OTHER;
+}
+
+// End of the block from i: UTF8_BLOCK bytes on, moved past continuation bytes.
+static inline size_t utf8_block_end(const uint8_t *s, size_t n, size_t i) {
+    size_t end = n - i > UTF8_BLOCK ? i + UTF8_BLOCK : n;
+    while (end < n && (s[end] & 0xc0) == 0x80) ++end;
+    return end;
+}
+
+// In a validated block, output never runs ahead of input (one unit per byte
+// at most), so the spare units utf8_step() widens past o stay inside the
+// n-unit buffer while 32 input bytes remain.
+static inline size_t utf8_to_utf32(const uint8_t *s, size_t n, uint32_t *out) {
+    if (!utf8_validate_fast) return utf8_to_utf32_checked(s, n, out);
+    size_t i = 0, o = 0;
+    while (i < n) {
+        size_t end = utf8_block_end(s, n, i);
+        enum utf8_kind kind = utf8_sample(s + i, end - i < UTF8_SAMPLE ? end - i : UTF8_SAMPLE);
+        if (kind == UTF8_MIXED) {
+            if (!utf8_validate(s + i, end - i)) return UTF_ERR;
+            while (i + 32 <= end) {
+                if (utf8_ascii_ahead_u8(s + i, end - i)) {
+                    size_t k = utf8_ascii_to_u32(s + i, end - i, out + o);
+                    i += k;
+                    o += k;
+                    continue;
+                }
+                uint32_t m;
+                utf8_widen16_u32(s + i, out + o);
+                size_t adv = utf8_step(s + i, &o, &m, NULL);
+                for (; m; m &= m - 1) utf8_decode_valid(s + i + __builtin_ctz(m), &out[o++]);
+                i += adv;
+            }
+        }
+        i = kind == UTF8_ASCIIY ? utf8_run_u32(s, n, i, end, true, out, &o)
+                                : utf8_checked_u32(s, n, i, end, out, &o);
+        if (i == UTF_ERR) return UTF_ERR;
+    }
+    return o;
+}
+
+static inline size_t utf8_to_utf16(const uint8_t *s, size_t n, uint16_t *out) {
+    if (!utf8_validate_fast) return utf8_to_utf16_checked(s, n, out);
+    size_t i = 0, o = 0;
+    uint32_t cp = 0;
+    while (i < n) {
+        size_t end = utf8_block_end(s, n, i);
+        enum utf8_kind kind = utf8_sample(s + i, end - i < UTF8_SAMPLE ? end - i : UTF8_SAMPLE);
+        if (kind == UTF8_MIXED) {
+            if (!utf8_validate(s + i, end - i)) return UTF_ERR;
+            while (i + 32 <= end) {
+                if (utf8_ascii_ahead_u8(s + i, end - i)) {
+                    size_t k = utf8_ascii_to_u16(s + i, end - i, out + o);
+                    i += k;
+                    o += k;
+                    continue;
+                }
+                uint32_t m, m4;
+                utf8_widen16_u16(s + i, out + o);
+                size_t adv = utf8_step(s + i, &o, &m, &m4);
+                if (!m4) { // no surrogate pairs: one unit per code point
+                    for (; m; m &= m - 1) {
+                        utf8_decode_valid(s + i + __builtin_ctz(m), &cp);
+                        out[o++] = (uint16_t)cp;
+                    }
+                } else {
+                    for (; m; m &= m - 1) {
+                        utf8_decode_valid(s + i + __builtin_ctz(m), &cp);
+                        o += utf16_put(cp, out + o);
+                    }
+                }
+                i += adv;
+            }
+        }
+        i = kind == UTF8_ASCIIY ? utf8_run_u16(s, n, i, end, true, out, &o)
+                                : utf8_checked_u16(s, n, i, end, out, &o);
+        if (i == UTF_ERR) return UTF_ERR;
+    }
+    return o;
+}
+
+static inline size_t utf16_to_utf8(const uint16_t *s, size_t n, uint8_t *out) {
+    size_t i = 0, o = 0;
+    while (i < n) {
+        if (s[i] < 0x80) {
+            if (!utf8_ascii_ahead_u16(s + i, n - i)) { out[o++] = (uint8_t)s[i++]; continue; }
+            size_t k = utf8_u16_to_ascii(s + i, n - i, out + o);
+            i += k;
+            o += k;
+            continue;
+        }
+        uint32_t cp = s[i++];
+        if (cp >= 0xd800 && cp <= 0xdfff) {
+            // high surrogate must be followed by a low one
+            if (cp >= 0xdc00 || i >= n || s[i] < 0xdc00 || s[i] > 0xdfff) return UTF_ERR;
+            cp = 0x10000 + ((cp - 0xd800) << 10 | (uint32_t)(s[i++] - 0xdc00));
+        }
+        o += utf8_encode_one(cp, out + o);
+    }
+    return o;
+}
+
+static inline size_t utf32_to_utf8(const uint32_t *s, size_t n, uint8_t *out) {
+    size_t o = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t cp = s[i];
+        if (cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) return UTF_ERR;
+        o += utf8_encode_one(cp, out + o);
+    }
+    return o;
+}
+
+#endif // UTF8_H